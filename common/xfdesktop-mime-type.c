@@ -86,30 +86,36 @@ xfdesktop_media_mime_type_to_filter(GtkFileFilter *filter) {
 }
 
 gboolean
-xfdesktop_file_has_media_mime_type(GFile *file) {
-    g_return_val_if_fail(file != NULL, FALSE);
-
-    gchar *file_mimetype = xfdesktop_get_file_mime_type(file);
-    if (file_mimetype == NULL) {
+xfdesktop_mime_type_is_media(const gchar *mime_type) {
+    if (mime_type == NULL) {
         return FALSE;
     } else {
         gboolean has = FALSE;
 
         if (!has) {
-            has = is_pixbuf_mimetype(file_mimetype);
+            has = is_pixbuf_mimetype(mime_type);
         }
 
 #ifdef ENABLE_VIDEO_BACKDROP
         if (!has) {
-            has = g_strv_contains(video_mime_type_list, file_mimetype);
+            has = g_strv_contains(video_mime_type_list, mime_type);
         }
 #endif /* ENABLE_VIDEO_BACKDROP */
 
-        g_free(file_mimetype);
         return has;
     }
 }
 
+gboolean
+xfdesktop_file_has_media_mime_type(GFile *file) {
+    g_return_val_if_fail(file != NULL, FALSE);
+
+    gchar *file_mimetype = xfdesktop_get_file_mime_type(file);
+    gboolean has = xfdesktop_mime_type_is_media(file_mimetype);
+    g_free(file_mimetype);
+    return has;
+}
+
 #ifdef ENABLE_VIDEO_BACKDROP
 gboolean
 xfdesktop_file_has_video_mime_type(GFile *file) {
@@ -27,6 +27,8 @@ gchar *xfdesktop_get_file_mime_type(GFile *file);
 
 void xfdesktop_media_mime_type_to_filter(GtkFileFilter *filter);
 
+gboolean xfdesktop_mime_type_is_media(const gchar *mime_type);
+
 gboolean xfdesktop_file_has_media_mime_type(GFile *file);
 
 #ifdef ENABLE_VIDEO_BACKDROP
@@ -0,0 +1,303 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <glib.h>
+#include <unistd.h>
+
+#include "xfdesktop-startup-trace.h"
+
+// Timestamps are taken relative to xfdesktop_startup_trace_init(), which
+// main() calls first thing; time spent before that (exec, dynamic linking)
+// isn't covered.
+
+// Once every phase has ended, wait this long for something else to start
+// before deciding startup is over.
+#define QUIET_PERIOD_MS 3000
+
+typedef struct {
+    const gchar *name;
+    gint64 start;
+    gint64 end;  // -1 while the phase is open
+    gboolean instant;
+} TraceEvent;
+
+static gboolean enabled = FALSE;
+static gint64 origin = 0;
+static gchar *json_filename = NULL;
+static GArray *events = NULL;  // TraceEvent
+static guint n_open = 0;
+static guint quiet_timeout_id = 0;
+
+static gint64
+now(void) {
+    return g_get_monotonic_time() - origin;
+}
+
+static gboolean
+quiet_timeout(gpointer data) {
+    quiet_timeout_id = 0;
+    xfdesktop_startup_trace_finish();
+    return G_SOURCE_REMOVE;
+}
+
+static void
+rearm_quiet_timeout(void) {
+    if (quiet_timeout_id != 0) {
+        g_source_remove(quiet_timeout_id);
+        quiet_timeout_id = 0;
+    }
+    if (n_open == 0) {
+        quiet_timeout_id = g_timeout_add(QUIET_PERIOD_MS, quiet_timeout, NULL);
+    }
+}
+
+static TraceEvent *
+find_open_phase(const gchar *phase) {
+    for (guint i = events->len; i > 0; --i) {
+        TraceEvent *event = &g_array_index(events, TraceEvent, i - 1);
+        if (!event->instant && event->end < 0 && g_strcmp0(event->name, phase) == 0) {
+            return event;
+        }
+    }
+    return NULL;
+}
+
+static gboolean
+has_event(const gchar *name) {
+    for (guint i = 0; i < events->len; ++i) {
+        if (g_strcmp0(g_array_index(events, TraceEvent, i).name, name) == 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * xfdesktop_startup_trace_init:
+ *
+ * Records the time that all trace timestamps are relative to, and turns
+ * tracing on if the XFDESKTOP_STARTUP_TRACE environment variable is set.  If
+ * its value is anything other than "1", it is taken as the name of a file to
+ * write a Chrome trace-event JSON file to.  Should be called as early as
+ * possible in main().
+ **/
+void
+xfdesktop_startup_trace_init(void) {
+    origin = g_get_monotonic_time();
+
+    const gchar *env = g_getenv(XFDESKTOP_STARTUP_TRACE_ENV);
+    if (env != NULL && env[0] != '\0' && g_strcmp0(env, "0") != 0) {
+        xfdesktop_startup_trace_enable(g_strcmp0(env, "1") != 0 ? env : NULL);
+    }
+}
+
+/**
+ * xfdesktop_startup_trace_enable:
+ * @filename: (nullable): where to write a Chrome trace-event file.
+ *
+ * Starts collecting startup phases.  A timing summary is printed once
+ * startup has settled down, and, if @filename is not %NULL, the same
+ * phases are written there, suitable for loading into chrome://tracing or
+ * Perfetto.
+ **/
+void
+xfdesktop_startup_trace_enable(const gchar *filename) {
+    if (events != NULL) {
+        // Already tracing, or already finished.
+        if (enabled && filename != NULL && json_filename == NULL) {
+            json_filename = g_strdup(filename);
+        }
+        return;
+    }
+
+    enabled = TRUE;
+    json_filename = g_strdup(filename);
+    events = g_array_new(FALSE, FALSE, sizeof(TraceEvent));
+    rearm_quiet_timeout();
+}
+
+gboolean
+xfdesktop_startup_trace_is_enabled(void) {
+    return enabled;
+}
+
+void
+xfdesktop_startup_trace_begin(const gchar *phase) {
+    if (G_LIKELY(!enabled)) {
+        return;
+    }
+
+    if (find_open_phase(phase) == NULL) {
+        TraceEvent event = {
+            .name = phase,
+            .start = now(),
+            .end = -1,
+            .instant = FALSE,
+        };
+        g_array_append_val(events, event);
+        n_open++;
+        rearm_quiet_timeout();
+    }
+}
+
+void
+xfdesktop_startup_trace_end(const gchar *phase) {
+    if (G_LIKELY(!enabled)) {
+        return;
+    }
+
+    // Ending a phase that never started is fine; it makes it easy to end
+    // phases on error paths without tracking whether they began.
+    TraceEvent *event = find_open_phase(phase);
+    if (event != NULL) {
+        event->end = now();
+        n_open--;
+        rearm_quiet_timeout();
+    }
+}
+
+/**
+ * xfdesktop_startup_trace_mark:
+ * @event_name: the name of the event.
+ *
+ * Records a point in time, such as the first paint of something.  Only the
+ * first occurrence of each event is kept.
+ **/
+void
+xfdesktop_startup_trace_mark(const gchar *event_name) {
+    if (G_LIKELY(!enabled)) {
+        return;
+    }
+
+    if (!has_event(event_name)) {
+        gint64 ts = now();
+        TraceEvent event = {
+            .name = event_name,
+            .start = ts,
+            .end = ts,
+            .instant = TRUE,
+        };
+        g_array_append_val(events, event);
+        rearm_quiet_timeout();
+    }
+}
+
+static gint
+compare_events(gconstpointer a, gconstpointer b) {
+    const TraceEvent *ea = a;
+    const TraceEvent *eb = b;
+    return ea->start < eb->start ? -1 : (ea->start > eb->start ? 1 : 0);
+}
+
+static void
+print_summary(gint64 finish_time) {
+    const TraceEvent *longest = NULL;
+
+    g_printerr("xfdesktop startup trace (ms since main() started):\n");
+    g_printerr("%10s %10s  %s\n", "start", "duration", "phase");
+    for (guint i = 0; i < events->len; ++i) {
+        const TraceEvent *event = &g_array_index(events, TraceEvent, i);
+        if (event->instant) {
+            g_printerr("%10.3f %10s  %s\n", event->start / 1000.0, "-", event->name);
+        } else if (event->end < 0) {
+            g_printerr("%10.3f %10s  %s (unfinished)\n", event->start / 1000.0, "-", event->name);
+        } else {
+            g_printerr("%10.3f %10.3f  %s\n", event->start / 1000.0, (event->end - event->start) / 1000.0, event->name);
+            if (longest == NULL || event->end - event->start > longest->end - longest->start) {
+                longest = event;
+            }
+        }
+    }
+
+    if (longest != NULL) {
+        g_printerr("longest phase: %s (%.3f ms)\n", longest->name, (longest->end - longest->start) / 1000.0);
+    }
+    g_printerr("trace finished at %.3f ms\n", finish_time / 1000.0);
+}
+
+static void
+write_chrome_trace(gint64 finish_time) {
+    GString *json = g_string_new("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    pid_t pid = getpid();
+
+    for (guint i = 0; i < events->len; ++i) {
+        const TraceEvent *event = &g_array_index(events, TraceEvent, i);
+        gchar *name = g_strescape(event->name, NULL);
+
+        if (i > 0) {
+            g_string_append_c(json, ',');
+        }
+
+        if (event->instant) {
+            g_string_append_printf(json,
+                                   "\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":%d,\"tid\":1}",
+                                   name, event->start, (gint)pid);
+        } else {
+            gint64 end = event->end >= 0 ? event->end : finish_time;
+            g_string_append_printf(json,
+                                   "\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ",\"pid\":%d,\"tid\":1%s}",
+                                   name, event->start, end - event->start, (gint)pid,
+                                   event->end >= 0 ? "" : ",\"args\":{\"unfinished\":true}");
+        }
+
+        g_free(name);
+    }
+
+    g_string_append(json, "\n]}\n");
+
+    GError *error = NULL;
+    if (!g_file_set_contents(json_filename, json->str, json->len, &error)) {
+        g_message("Unable to write startup trace to %s: %s", json_filename, error->message);
+        g_error_free(error);
+    }
+
+    g_string_free(json, TRUE);
+}
+
+/**
+ * xfdesktop_startup_trace_finish:
+ *
+ * Stops tracing, prints the summary, and writes the trace file if one was
+ * requested.  Called automatically once no phase has been running for a
+ * few seconds; it's also safe to call at shutdown, or more than once.
+ **/
+void
+xfdesktop_startup_trace_finish(void) {
+    if (!enabled) {
+        return;
+    }
+
+    enabled = FALSE;
+    if (quiet_timeout_id != 0) {
+        g_source_remove(quiet_timeout_id);
+        quiet_timeout_id = 0;
+    }
+
+    gint64 finish_time = now();
+    g_array_sort(events, compare_events);
+
+    print_summary(finish_time);
+    if (json_filename != NULL) {
+        write_chrome_trace(finish_time);
+    }
+
+    // Keep 'events' around (but empty), so a late enable doesn't restart
+    // tracing after startup is long over.
+    g_array_set_size(events, 0);
+    g_clear_pointer(&json_filename, g_free);
+}
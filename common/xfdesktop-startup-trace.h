@@ -0,0 +1,44 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __XFDESKTOP_STARTUP_TRACE_H__
+#define __XFDESKTOP_STARTUP_TRACE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define XFDESKTOP_STARTUP_TRACE_ENV "XFDESKTOP_STARTUP_TRACE"
+
+// All of these must be called from the main thread.  Phase and event names
+// are not copied, so they must be string literals or interned strings.  When tracing is not
+// enabled, every call is a single branch.
+
+void xfdesktop_startup_trace_init(void);
+void xfdesktop_startup_trace_enable(const gchar *filename);
+gboolean xfdesktop_startup_trace_is_enabled(void);
+
+void xfdesktop_startup_trace_begin(const gchar *phase);
+void xfdesktop_startup_trace_end(const gchar *phase);
+void xfdesktop_startup_trace_mark(const gchar *event_name);
+
+void xfdesktop_startup_trace_finish(void);
+
+G_END_DECLS
+
+#endif  /* __XFDESKTOP_STARTUP_TRACE_H__ */
@@ -45,6 +45,21 @@
 #define MAX_ASPECT_RATIO 1.5f
 #define PREVIEW_HEIGHT 96
 #define PREVIEW_WIDTH (PREVIEW_HEIGHT * MAX_ASPECT_RATIO)
+#define PREVIEW_MAX_THREADS 4
+#define PREVIEW_BATCH_INTERVAL_MS 50
+#define PREVIEW_BATCH_SIZE 64
+/* Rows within this many screenfuls of the visible ones (but at least
+ * PREVIEW_NEARBY_MIN rows) are next in line for previews */
+#define PREVIEW_NEARBY_PAGES 2
+#define PREVIEW_NEARBY_MIN 32
+#define PREVIEW_RANK_FAR G_MAXINT
+#define ENUMERATION_BATCH_SIZE_MIN 32
+#define ENUMERATION_BATCH_SIZE_MAX 1024
+#define FOLDER_CACHE_MAX_FOLDERS 4
+#define FOLDER_CACHE_MAX_IMAGES 4000
+#define BACKGROUND_DIRS_CACHE_RELPATH "xfce4/xfdesktop/background-dirs.cache"
+#define BACKGROUND_DIRS_CACHE_KEY_MTIME "mtime"
+#define BACKGROUND_DIRS_CACHE_KEY_HAS_IMAGES "has-images"
 
 struct _XfdesktopBackgroundSettings {
     XfdesktopSettings *settings;
@@ -63,6 +78,12 @@ struct _XfdesktopBackgroundSettings {
     gboolean image_list_loaded;
 
     GtkListStore *preview_model;
+    // Collation keys of the rows in preview_model, in the same order, so we
+    // can binary-search for insertion points without touching the model.
+    GPtrArray *preview_collate_keys;
+    // FolderCacheEntry, most recently used first; the first one is the
+    // folder being shown (or loaded).
+    GList *folder_cache;
 
     GtkWidget *infobar;
     GtkWidget *infobar_label;
@@ -91,7 +112,21 @@ struct _XfdesktopBackgroundSettings {
     GtkWidget *random_backdrop_order_chkbox;
 
     guint preview_id;
+    GThreadPool *preview_pool;
+    // Finished previews, pushed by the preview pool's worker threads and
+    // drained in batches on the main thread.
     GAsyncQueue *preview_queue;
+    // Every PreviewData that's been queued and not yet applied, so the
+    // ones for a single row can be called off.
+    GHashTable *previews_pending;
+    gint preview_generation;  // atomic
+    guint n_previews_outstanding;
+    guint preview_seq;
+    gint preview_visible_start;
+    gint preview_visible_end;
+    // Rows were added to or removed from the model since the preview queue
+    // was last sorted, so the rows waiting in it have moved.
+    gboolean preview_order_stale;
 
     XfdesktopThumbnailer *thumbnailer;
 
@@ -99,18 +134,75 @@ struct _XfdesktopBackgroundSettings {
     GCancellable *cancel_enumeration;
     guint add_dir_idle_id;
 
+    /* default wallpaper folder discovery */
+    guint background_dirs_idle_id;
+    GCancellable *background_dirs_cancellable;
+    GHashTable *background_dirs_seen;  // GFile
+    GList *background_dirs;  // GFile, in the order they were found
+    GKeyFile *background_dirs_cache;
+    gboolean background_dirs_cache_dirty;
+    guint n_background_dir_checks;
+
     guint last_image_signal_id;
 };
 
+// Everything in here must be safe to touch from the preview worker threads,
+// so we only hold on to a copy of the row's iter, and use the generation to
+// make sure it still refers to the current model before using it.  A row
+// that's removed or rewritten instead marks its own previews obsolete.
 typedef struct {
-    GtkTreeModel *model;
-    GtkTreeIter *iter;
-    GdkPixbuf *pix;
+    GtkTreeIter iter;
+    gchar *filename;
+    gchar *thumbnail;
     gint scale_factor;
+    guint generation;
+    gint obsolete;  // atomic
+    guint seq;
+    // Where the preview is in line, as of the last time the visible range
+    // changed; only touched on the main thread.
+    gint rank;
+    GdkPixbuf *pix;
 } PreviewData;
 
+typedef struct {
+    gchar *collate_key;
+    gchar *name_markup;
+    GFile *file;
+} ImageListEntry;
+
+typedef struct {
+    XfdesktopBackgroundSettings *background_settings;
+    GFile *folder;
+    // The list store and collation keys for the folder; preview_model and
+    // preview_collate_keys point at these while the folder is shown.
+    GtkListStore *model;
+    GPtrArray *collate_keys;
+    GFileMonitor *monitor;
+    GCancellable *cancellable;
+    // Until the folder has been enumerated, changes reported by the monitor
+    // are held here (FolderChange, newest first) and applied afterward.
+    gboolean complete;
+    GList *pending_changes;
+    // Files the monitor saw being created, whose contents aren't final until
+    // the CHANGES_DONE_HINT that follows.
+    GHashTable *created_files;  // GFile
+} FolderCacheEntry;
+
+typedef struct {
+    GFile *file;
+    gboolean added;
+} FolderChange;
+
+typedef struct {
+    XfdesktopBackgroundSettings *background_settings;
+    GFile *dir;
+    guint64 mtime;
+    GFileEnumerator *enumerator;
+} BackgroundDirCheck;
+
 typedef struct {
     GFileEnumerator *file_enumerator;
+    gint batch_size;
     GtkTreeIter *selected_iter;
     gchar *last_image;
     gchar *file_path;
@@ -123,7 +215,6 @@ enum {
     COL_NAME,
     COL_FILENAME,
     COL_THUMBNAIL,
-    COL_COLLATE_KEY,
     N_COLS,
 };
 
@@ -141,6 +232,14 @@ static void cb_xfdesktop_chk_apply_to_all(GtkCheckButton *button,
 
 static gboolean update_icon_view_model(XfdesktopBackgroundSettings *background_settings);
 
+static gchar *image_list_collate_key(const gchar *filename);
+static gboolean image_list_find_file(GtkListStore *model,
+                                     GPtrArray *keys,
+                                     const gchar *key,
+                                     const gchar *filename,
+                                     GtkTreeIter *iter_out,
+                                     guint *position_out);
+
 static void combobox_allow_only_supported_image_styles(XfdesktopBackgroundSettings *background_settings);
 
 static void show_only_supported_settings(XfdesktopBackgroundSettings *background_settings);
@@ -154,48 +253,185 @@ static gboolean last_media_file_is_video(XfdesktopBackgroundSettings *background
 static void reset_to_supported_options(XfdesktopBackgroundSettings *background_settings);
 #endif /* ENABLE_VIDEO_BACKDROP */
 
-static gboolean
-path_has_image_files(GFile *dir) {
-    GFileEnumerator *enumerator = g_file_enumerate_children(dir,
-                                                            G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
-                                                            G_FILE_QUERY_INFO_NONE,
-                                                            NULL,
-                                                            NULL);
-    if (enumerator != NULL) {
-        gboolean has_image_files = FALSE;
+static void
+add_background_dir_shortcut(XfdesktopBackgroundSettings *background_settings, GFile *dir) {
+    gchar *uri = g_file_get_uri(dir);
+    gtk_file_chooser_add_shortcut_folder_uri(GTK_FILE_CHOOSER(background_settings->btn_folder), uri, NULL);
+    g_free(uri);
+}
 
-        for (;;) {
-            GFileInfo *file_info = g_file_enumerator_next_file(enumerator, NULL, NULL);
-            if (file_info == NULL) {
-                break;
-            } else {
-                const gchar *content_type = g_file_info_get_content_type(file_info);
-                has_image_files = content_type != NULL && g_str_has_prefix(content_type, "image/");
-                g_object_unref(file_info);
+static void
+add_background_dir(XfdesktopBackgroundSettings *background_settings, GFile *dir) {
+    background_settings->background_dirs = g_list_append(background_settings->background_dirs, g_object_ref(dir));
+    add_background_dir_shortcut(background_settings, dir);
+}
 
-                if (has_image_files) {
-                    break;
-                }
+static void
+background_dirs_cache_save(XfdesktopBackgroundSettings *background_settings) {
+    if (background_settings->background_dirs_cache_dirty) {
+        gchar *cache_path = xfce_resource_save_location(XFCE_RESOURCE_CACHE, BACKGROUND_DIRS_CACHE_RELPATH, TRUE);
+        if (cache_path != NULL) {
+            GError *error = NULL;
+            if (!g_key_file_save_to_file(background_settings->background_dirs_cache, cache_path, &error)) {
+                g_message("Failed to save background folder cache: %s", error->message);
+                g_error_free(error);
             }
+            g_free(cache_path);
         }
+        background_settings->background_dirs_cache_dirty = FALSE;
+    }
+}
+
+static void
+background_dir_check_free(BackgroundDirCheck *check) {
+    g_object_unref(check->dir);
+    if (check->enumerator != NULL) {
+        g_object_unref(check->enumerator);
+    }
+    g_free(check);
+}
+
+static void
+background_dir_check_finish(BackgroundDirCheck *check, gboolean has_image_files) {
+    XfdesktopBackgroundSettings *background_settings = check->background_settings;
+    const gchar *path = g_file_peek_path(check->dir);
+
+    g_key_file_set_uint64(background_settings->background_dirs_cache, path, BACKGROUND_DIRS_CACHE_KEY_MTIME, check->mtime);
+    g_key_file_set_boolean(background_settings->background_dirs_cache, path, BACKGROUND_DIRS_CACHE_KEY_HAS_IMAGES, has_image_files);
+    background_settings->background_dirs_cache_dirty = TRUE;
+
+    if (has_image_files) {
+        add_background_dir(background_settings, check->dir);
+    }
+
+    background_dir_check_free(check);
 
-        g_object_unref(enumerator);
-        return has_image_files;
+    if (--background_settings->n_background_dir_checks == 0) {
+        background_dirs_cache_save(background_settings);
+    }
+}
+
+static void
+background_dir_files_ready(GObject *source, GAsyncResult *res, gpointer user_data) {
+    BackgroundDirCheck *check = user_data;
+
+    GError *error = NULL;
+    GList *file_infos = g_file_enumerator_next_files_finish(G_FILE_ENUMERATOR(source), res, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        /* The dialog is going away; don't touch background_settings */
+        g_error_free(error);
+        background_dir_check_free(check);
+    } else if (error != NULL || file_infos == NULL) {
+        g_clear_error(&error);
+        background_dir_check_finish(check, FALSE);
     } else {
-        return FALSE;
+        gboolean has_image_files = FALSE;
+
+        for (GList *l = file_infos; l != NULL && !has_image_files; l = l->next) {
+            const gchar *content_type = g_file_info_get_content_type(G_FILE_INFO(l->data));
+            has_image_files = content_type != NULL && g_str_has_prefix(content_type, "image/");
+        }
+        g_list_free_full(file_infos, g_object_unref);
+
+        if (has_image_files) {
+            background_dir_check_finish(check, TRUE);
+        } else {
+            g_file_enumerator_next_files_async(check->enumerator,
+                                               ENUMERATION_BATCH_SIZE_MIN,
+                                               G_PRIORITY_LOW,
+                                               check->background_settings->background_dirs_cancellable,
+                                               background_dir_files_ready,
+                                               check);
+        }
     }
 }
 
-static gint
-xfdesktop_g_file_compare(gconstpointer a, gconstpointer b) {
-    GFile *fa = G_FILE((gpointer)a);
-    GFile *fb = G_FILE((gpointer)b);
-    return g_file_equal(fa, fb) ? 0 : -1;
+static void
+background_dir_enumerate_ready(GObject *source, GAsyncResult *res, gpointer user_data) {
+    BackgroundDirCheck *check = user_data;
+
+    GError *error = NULL;
+    check->enumerator = g_file_enumerate_children_finish(G_FILE(source), res, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        background_dir_check_free(check);
+    } else if (check->enumerator == NULL) {
+        g_clear_error(&error);
+        background_dir_check_finish(check, FALSE);
+    } else {
+        g_file_enumerator_next_files_async(check->enumerator,
+                                           ENUMERATION_BATCH_SIZE_MIN,
+                                           G_PRIORITY_LOW,
+                                           check->background_settings->background_dirs_cancellable,
+                                           background_dir_files_ready,
+                                           check);
+    }
+}
+
+static void
+background_dir_info_ready(GObject *source, GAsyncResult *res, gpointer user_data) {
+    BackgroundDirCheck *check = user_data;
+
+    GError *error = NULL;
+    GFileInfo *info = g_file_query_info_finish(G_FILE(source), res, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        background_dir_check_free(check);
+    } else if (info == NULL) {
+        g_clear_error(&error);
+        background_dir_check_finish(check, FALSE);
+    } else {
+        XfdesktopBackgroundSettings *background_settings = check->background_settings;
+        const gchar *path = g_file_peek_path(check->dir);
+
+        check->mtime = g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+        g_object_unref(info);
+
+        /* A directory's mtime changes whenever files get added or removed, so
+         * if it hasn't changed, neither has the answer */
+        GError *cache_error = NULL;
+        guint64 cached_mtime = g_key_file_get_uint64(background_settings->background_dirs_cache,
+                                                     path,
+                                                     BACKGROUND_DIRS_CACHE_KEY_MTIME,
+                                                     &cache_error);
+        if (cache_error == NULL && cached_mtime == check->mtime) {
+            gboolean has_image_files = g_key_file_get_boolean(background_settings->background_dirs_cache,
+                                                              path,
+                                                              BACKGROUND_DIRS_CACHE_KEY_HAS_IMAGES,
+                                                              NULL);
+            XF_DEBUG("using cached result for background folder %s", path);
+            if (has_image_files) {
+                add_background_dir(background_settings, check->dir);
+            }
+            background_dir_check_free(check);
+            if (--background_settings->n_background_dir_checks == 0) {
+                background_dirs_cache_save(background_settings);
+            }
+        } else {
+            g_clear_error(&cache_error);
+            g_file_enumerate_children_async(check->dir,
+                                            G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+                                            G_FILE_QUERY_INFO_NONE,
+                                            G_PRIORITY_LOW,
+                                            background_settings->background_dirs_cancellable,
+                                            background_dir_enumerate_ready,
+                                            check);
+        }
+    }
 }
 
-static GList *
-find_background_directories(void) {
-    GList *directories = NULL;
+static gboolean
+find_background_directories(gpointer data) {
+    XfdesktopBackgroundSettings *background_settings = data;
+
+    background_settings->background_dirs_idle_id = 0;
+
+    background_settings->background_dirs_cache = g_key_file_new();
+    gchar *cache_path = xfce_resource_lookup(XFCE_RESOURCE_CACHE, BACKGROUND_DIRS_CACHE_RELPATH);
+    if (cache_path != NULL) {
+        g_key_file_load_from_file(background_settings->background_dirs_cache, cache_path, G_KEY_FILE_NONE, NULL);
+        g_free(cache_path);
+    }
 
     gchar **xfce_background_dirs = xfce_resource_lookup_all(XFCE_RESOURCE_DATA, "backgrounds/xfce/");
     gchar **background_dirs = xfce_resource_lookup_all(XFCE_RESOURCE_DATA, "backgrounds/");
@@ -207,27 +443,72 @@ find_background_directories(void) {
     for (gsize i = 0; i < G_N_ELEMENTS(dirs_dirs); ++i) {
         for (gsize j = 0; dirs_dirs[i][j] != NULL; ++j) {
             GFile *dir = g_file_new_for_path(dirs_dirs[i][j]);
-            if (path_has_image_files(dir) && g_list_find_custom(directories, dir, xfdesktop_g_file_compare) == NULL) {
-                directories = g_list_prepend(directories, dir);
-            } else {
-                g_object_unref(dir);
+            if (!g_hash_table_contains(background_settings->background_dirs_seen, dir)) {
+                g_hash_table_add(background_settings->background_dirs_seen, g_object_ref(dir));
+
+                BackgroundDirCheck *check = g_new0(BackgroundDirCheck, 1);
+                check->background_settings = background_settings;
+                check->dir = g_object_ref(dir);
+                background_settings->n_background_dir_checks++;
+
+                g_file_query_info_async(dir,
+                                        G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                        G_FILE_QUERY_INFO_NONE,
+                                        G_PRIORITY_LOW,
+                                        background_settings->background_dirs_cancellable,
+                                        background_dir_info_ready,
+                                        check);
             }
+            g_object_unref(dir);
         }
         g_strfreev(dirs_dirs[i]);
     }
 
-    directories = g_list_reverse(directories);
+    return G_SOURCE_REMOVE;
+}
+
+/* The folder holding the default backdrop is always offered, and the rest get
+ * checked for images in the background once the dialog is up, filling in the
+ * folder chooser's shortcuts as they're found. */
+static void
+start_background_directory_discovery(XfdesktopBackgroundSettings *background_settings) {
+    background_settings->background_dirs_seen = g_hash_table_new_full(g_file_hash,
+                                                                      (GEqualFunc)g_file_equal,
+                                                                      g_object_unref,
+                                                                      NULL);
+    background_settings->background_dirs_cancellable = g_cancellable_new();
 
     GFile *default_background = g_file_new_for_path(DEFAULT_BACKDROP);
     GFile *parent = g_file_get_parent(default_background);
-    if (g_list_find_custom(directories, parent, xfdesktop_g_file_compare) == NULL) {
-        directories = g_list_prepend(directories, parent);
-    } else {
+    if (parent != NULL) {
+        g_hash_table_add(background_settings->background_dirs_seen, g_object_ref(parent));
+        add_background_dir(background_settings, parent);
         g_object_unref(parent);
     }
     g_object_unref(default_background);
 
-    return directories;
+    background_settings->background_dirs_idle_id = g_idle_add_full(G_PRIORITY_LOW,
+                                                                   find_background_directories,
+                                                                   background_settings,
+                                                                   NULL);
+}
+
+static void
+stop_background_directory_discovery(XfdesktopBackgroundSettings *background_settings) {
+    if (background_settings->background_dirs_idle_id != 0) {
+        g_source_remove(background_settings->background_dirs_idle_id);
+    }
+    g_cancellable_cancel(background_settings->background_dirs_cancellable);
+    g_object_unref(background_settings->background_dirs_cancellable);
+
+    /* Save whatever we've learned so far, even if we didn't finish */
+    if (background_settings->background_dirs_cache != NULL) {
+        background_dirs_cache_save(background_settings);
+        g_key_file_free(background_settings->background_dirs_cache);
+    }
+
+    g_hash_table_destroy(background_settings->background_dirs_seen);
+    g_list_free_full(background_settings->background_dirs, g_object_unref);
 }
 
 static void
@@ -253,14 +534,17 @@ create_file_chooser_button(XfdesktopBackgroundSettings *background_settings) {
     g_signal_connect(G_OBJECT(background_settings->btn_folder), "selection-changed",
                      G_CALLBACK(cb_folder_selection_changed), background_settings);
 
+    for (GList *l = background_settings->background_dirs; l != NULL; l = l->next) {
+        add_background_dir_shortcut(background_settings, G_FILE(l->data));
+    }
+
     gtk_label_set_mnemonic_widget(GTK_LABEL(background_settings->label_folder), background_settings->btn_folder);
 }
 
 static void
 xfdesktop_settings_free_pdata(PreviewData *pdata) {
-    g_object_unref(pdata->model);
-
-    gtk_tree_iter_free(pdata->iter);
+    g_free(pdata->filename);
+    g_free(pdata->thumbnail);
 
     if (pdata->pix != NULL) {
         g_object_unref(pdata->pix);
@@ -269,98 +553,241 @@ xfdesktop_settings_free_pdata(PreviewData *pdata) {
     g_free(pdata);
 }
 
+/* Runs in the preview thread pool. */
 static void
-xfdesktop_settings_do_single_preview(PreviewData *pdata) {
-    g_return_if_fail(pdata);
+xfdesktop_settings_do_single_preview(gpointer data, gpointer user_data) {
+    PreviewData *pdata = data;
+    XfdesktopBackgroundSettings *background_settings = user_data;
 
-    GtkTreeModel *model = pdata->model;
-    GtkTreeIter *iter = pdata->iter;
+    /* Skip the actual decoding if the folder or the row changed since we
+     * were queued; the main thread will just throw the result away. */
+    if ((guint)g_atomic_int_get(&background_settings->preview_generation) == pdata->generation
+        && !g_atomic_int_get(&pdata->obsolete))
+    {
+        /* If we didn't create a thumbnail there might not be a thumbnailer service
+         * or it may not support that format */
+        const gchar *path;
+        if (pdata->thumbnail == NULL) {
+            XF_DEBUG("generating thumbnail for filename %s", pdata->filename);
+            path = pdata->filename;
+        } else {
+            XF_DEBUG("loading thumbnail %s", pdata->thumbnail);
+            path = pdata->thumbnail;
+        }
 
-    gchar *filename = NULL, *thumbnail = NULL;
-    gtk_tree_model_get(model, iter,
-                       COL_FILENAME, &filename,
-                       COL_THUMBNAIL, &thumbnail,
-                       -1);
+        pdata->pix = gdk_pixbuf_new_from_file_at_scale(path,
+                                                       PREVIEW_WIDTH * pdata->scale_factor,
+                                                       PREVIEW_HEIGHT * pdata->scale_factor,
+                                                       TRUE,
+                                                       NULL);
+    }
 
-    /* If we didn't create a thumbnail there might not be a thumbnailer service
-     * or it may not support that format */
-    GdkPixbuf *pix;
-    if (thumbnail == NULL) {
-        XF_DEBUG("generating thumbnail for filename %s", filename);
-        pix = gdk_pixbuf_new_from_file_at_scale(filename,
-                                                PREVIEW_WIDTH * pdata->scale_factor, PREVIEW_HEIGHT * pdata->scale_factor,
-                                                TRUE, NULL);
+    g_async_queue_push(background_settings->preview_queue, pdata);
+}
+
+/* Where @pdata's row is in the model right now, or -1 if it's not in the
+ * current model anymore.  Rows get inserted and removed while previews wait
+ * in the queue, so where the row was when it was queued doesn't mean much.
+ * Looking up the row's path isn't cheap, so this is only done when ranking
+ * a preview, never from the pool's sort function. */
+static gint
+preview_data_position(XfdesktopBackgroundSettings *background_settings, const PreviewData *pdata) {
+    gint position = -1;
+
+    if (background_settings->preview_model != NULL
+        && (guint)g_atomic_int_get(&background_settings->preview_generation) == pdata->generation
+        && !g_atomic_int_get((gint *)&pdata->obsolete))
+    {
+        GtkTreePath *path = gtk_tree_model_get_path(GTK_TREE_MODEL(background_settings->preview_model),
+                                                    (GtkTreeIter *)&pdata->iter);
+        if (path != NULL) {
+            position = gtk_tree_path_get_indices(path)[0];
+            gtk_tree_path_free(path);
+        }
+    }
+
+    return position;
+}
+
+/* Lower ranks get their previews first: 0 for visible rows, then the
+ * distance from the visible range for rows near it, and PREVIEW_RANK_FAR
+ * for everything else (or for everything, if nothing is visible yet). */
+static gint
+preview_data_rank(XfdesktopBackgroundSettings *background_settings, const PreviewData *pdata) {
+    gint start = background_settings->preview_visible_start;
+    gint end = background_settings->preview_visible_end;
+
+    if (start < 0 || end < start) {
+        return PREVIEW_RANK_FAR;
+    }
+
+    gint position = preview_data_position(background_settings, pdata);
+    if (position < 0) {
+        return PREVIEW_RANK_FAR;
+    } else if (position >= start && position <= end) {
+        return 0;
     } else {
-        XF_DEBUG("loading thumbnail %s", thumbnail);
-        pix = gdk_pixbuf_new_from_file_at_scale(thumbnail,
-                                                PREVIEW_WIDTH * pdata->scale_factor, PREVIEW_HEIGHT * pdata->scale_factor,
-                                                TRUE, NULL);
-        g_free(thumbnail);
+        gint nearby = MAX((end - start + 1) * PREVIEW_NEARBY_PAGES, PREVIEW_NEARBY_MIN);
+        gint distance = position < start ? start - position : position - end;
+        return distance <= nearby ? distance : PREVIEW_RANK_FAR;
     }
+}
 
-    g_free(filename);
+/* The pool sorts its queue with this on every push, so it only compares
+ * the ranks worked out beforehand. */
+static gint
+preview_data_compare(gconstpointer a, gconstpointer b, gpointer user_data) {
+    const PreviewData *pdata_a = a;
+    const PreviewData *pdata_b = b;
+
+    if (pdata_a->rank != pdata_b->rank) {
+        return pdata_a->rank < pdata_b->rank ? -1 : 1;
+    } else if (pdata_a->seq < pdata_b->seq) {
+        return -1;
+    } else if (pdata_a->seq > pdata_b->seq) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
 
-    if (pix != NULL) {
-        cairo_surface_t *surface;
+static void
+xfdesktop_settings_set_preview_visible_range(XfdesktopBackgroundSettings *background_settings, gint start, gint end) {
+    if (start != background_settings->preview_visible_start
+        || end != background_settings->preview_visible_end
+        || background_settings->preview_order_stale)
+    {
+        background_settings->preview_visible_start = start;
+        background_settings->preview_visible_end = end;
+        background_settings->preview_order_stale = FALSE;
 
-        pdata->pix = pix;
+        GHashTableIter hiter;
+        PreviewData *pdata;
+        g_hash_table_iter_init(&hiter, background_settings->previews_pending);
+        while (g_hash_table_iter_next(&hiter, (gpointer *)&pdata, NULL)) {
+            pdata->rank = preview_data_rank(background_settings, pdata);
+        }
 
-        /* set the image */
-        surface = gdk_cairo_surface_create_from_pixbuf(pix, pdata->scale_factor, NULL);
-        gtk_list_store_set(GTK_LIST_STORE(pdata->model), pdata->iter,
-                           COL_PIX, pdata->pix,
-                           COL_SURFACE, surface,
-                           -1);
-        cairo_surface_destroy(surface);
+        /* Setting the sort function again re-sorts whatever is still waiting
+         * in the pool's queue, so anything scrolled (or pushed) far away
+         * falls to the back. */
+        g_thread_pool_set_sort_function(background_settings->preview_pool,
+                                        preview_data_compare,
+                                        NULL);
+    }
+}
+
+static void
+xfdesktop_settings_update_preview_visible_range(XfdesktopBackgroundSettings *background_settings) {
+    gint start = -1, end = -1;
+    GtkTreePath *start_path = NULL, *end_path = NULL;
 
+    if (gtk_icon_view_get_visible_range(GTK_ICON_VIEW(background_settings->image_iconview), &start_path, &end_path)) {
+        start = gtk_tree_path_get_indices(start_path)[0];
+        end = gtk_tree_path_get_indices(end_path)[0];
+        gtk_tree_path_free(start_path);
+        gtk_tree_path_free(end_path);
     }
-    xfdesktop_settings_free_pdata(pdata);
+
+    xfdesktop_settings_set_preview_visible_range(background_settings, start, end);
+}
+
+static void
+xfdesktop_settings_push_preview(XfdesktopBackgroundSettings *background_settings, PreviewData *pdata) {
+    pdata->rank = preview_data_rank(background_settings, pdata);
+    g_hash_table_add(background_settings->previews_pending, pdata);
+    g_thread_pool_push(background_settings->preview_pool, pdata, NULL);
 }
 
 static gboolean
 xfdesktop_settings_create_previews(gpointer data) {
     XfdesktopBackgroundSettings *background_settings = data;
+    guint generation = (guint)g_atomic_int_get(&background_settings->preview_generation);
+
+    xfdesktop_settings_update_preview_visible_range(background_settings);
 
-    if(background_settings->preview_queue != NULL) {
+    for (guint i = 0; i < PREVIEW_BATCH_SIZE; ++i) {
         PreviewData *pdata = g_async_queue_try_pop(background_settings->preview_queue);
+        if (pdata == NULL) {
+            break;
+        }
 
-        if (pdata != NULL) {
-            xfdesktop_settings_do_single_preview(pdata);
-            /* Continue on the next idle time */
-            return TRUE;
-        } else {
-            /* Nothing left, remove the queue, we're done with it */
-            g_async_queue_unref(background_settings->preview_queue);
-            background_settings->preview_queue = NULL;
+        background_settings->n_previews_outstanding--;
+        g_hash_table_remove(background_settings->previews_pending, pdata);
+
+        if (pdata->generation == generation
+            && !g_atomic_int_get(&pdata->obsolete)
+            && pdata->pix != NULL
+            && background_settings->preview_model != NULL)
+        {
+            /* set the image */
+            cairo_surface_t *surface = gdk_cairo_surface_create_from_pixbuf(pdata->pix, pdata->scale_factor, NULL);
+            gtk_list_store_set(background_settings->preview_model, &pdata->iter,
+                               COL_PIX, pdata->pix,
+                               COL_SURFACE, surface,
+                               -1);
+            cairo_surface_destroy(surface);
         }
+
+        xfdesktop_settings_free_pdata(pdata);
     }
 
-    /* clear the idle source */
-    background_settings->preview_id = 0;
+    if (background_settings->n_previews_outstanding > 0) {
+        /* Continue on the next batch */
+        return TRUE;
+    } else {
+        /* clear the timeout source */
+        background_settings->preview_id = 0;
 
-    /* stop this idle source */
-    return FALSE;
+        /* stop this timeout source */
+        return FALSE;
+    }
 }
 
 static void
-xfdesktop_settings_add_file_to_queue(XfdesktopBackgroundSettings *background_settings, PreviewData *pdata)
+xfdesktop_settings_add_file_to_queue(XfdesktopBackgroundSettings *background_settings,
+                                     GtkTreeIter *iter,
+                                     const gchar *filename,
+                                     const gchar *thumbnail)
 {
     TRACE("entering");
 
     g_return_if_fail(background_settings != NULL);
-    g_return_if_fail(pdata != NULL);
+    g_return_if_fail(iter != NULL);
+    g_return_if_fail(filename != NULL);
 
-    /* Create the queue if it doesn't exist */
-    if (background_settings->preview_queue == NULL) {
-        XF_DEBUG("creating preview queue");
-        background_settings->preview_queue = g_async_queue_new_full((GDestroyNotify)xfdesktop_settings_free_pdata);
-    }
+    PreviewData *pdata = g_new0(PreviewData, 1);
+    pdata->iter = *iter;
+    pdata->filename = g_strdup(filename);
+    pdata->thumbnail = g_strdup(thumbnail);
+    pdata->scale_factor = gtk_widget_get_scale_factor(GTK_WIDGET(background_settings->image_iconview));
+    pdata->generation = (guint)g_atomic_int_get(&background_settings->preview_generation);
+    pdata->seq = background_settings->preview_seq++;
 
-    g_async_queue_push(background_settings->preview_queue, pdata);
+    background_settings->n_previews_outstanding++;
+    xfdesktop_settings_push_preview(background_settings, pdata);
 
-    /* Create the previews in an idle callback */
+    /* Apply the finished previews in batches on the main loop */
     if (background_settings->preview_id == 0) {
-        background_settings->preview_id = g_idle_add(xfdesktop_settings_create_previews, background_settings);
+        background_settings->preview_id = g_timeout_add(PREVIEW_BATCH_INTERVAL_MS,
+                                                        xfdesktop_settings_create_previews,
+                                                        background_settings);
+    }
+}
+
+/* Calls off any previews still queued or being decoded for @iter's row in the
+ * current model, because the row is going away or its file changed. */
+static void
+xfdesktop_settings_drop_queued_previews(XfdesktopBackgroundSettings *background_settings, GtkTreeIter *iter) {
+    guint generation = (guint)g_atomic_int_get(&background_settings->preview_generation);
+    GHashTableIter hiter;
+    PreviewData *pdata;
+
+    g_hash_table_iter_init(&hiter, background_settings->previews_pending);
+    while (g_hash_table_iter_next(&hiter, (gpointer *)&pdata, NULL)) {
+        if (pdata->generation == generation && pdata->iter.user_data == iter->user_data) {
+            g_atomic_int_set(&pdata->obsolete, TRUE);
+        }
     }
 }
 
@@ -371,36 +798,25 @@ cb_thumbnail_ready(XfdesktopThumbnailer *thumbnailer,
                    XfdesktopBackgroundSettings *background_settings)
 {
     g_return_if_fail(GTK_IS_LIST_STORE(background_settings->preview_model));
-    GtkTreeModel *model = GTK_TREE_MODEL(background_settings->preview_model);
 
+    /* We're looking for the src_file */
+    gchar *key = image_list_collate_key(src_file);
     GtkTreeIter iter;
-    if (gtk_tree_model_get_iter_first(model, &iter)) {
-        do {
-            gchar *filename = NULL;
-            gtk_tree_model_get(model, &iter, COL_FILENAME, &filename, -1);
-
-            /* We're looking for the src_file */
-            if (g_strcmp0(filename, src_file) == 0) {
-                /* Add the thumb_file to it */
-                gtk_list_store_set(background_settings->preview_model, &iter,
-                                   COL_THUMBNAIL, thumb_file, -1);
-
-                PreviewData *pdata = g_new0(PreviewData, 1);
-                pdata->model = g_object_ref(model);
-                pdata->iter = gtk_tree_iter_copy(&iter);
-                pdata->pix = NULL;
-                pdata->scale_factor = gtk_widget_get_scale_factor(GTK_WIDGET(background_settings->image_iconview));
-
-                /* Create the preview image */
-                xfdesktop_settings_add_file_to_queue(background_settings, pdata);
-
-                g_free(filename);
-                break;
-            }
+    if (key != NULL && image_list_find_file(background_settings->preview_model,
+                                            background_settings->preview_collate_keys,
+                                            key,
+                                            src_file,
+                                            &iter,
+                                            NULL))
+    {
+        /* Add the thumb_file to it */
+        gtk_list_store_set(background_settings->preview_model, &iter,
+                           COL_THUMBNAIL, thumb_file, -1);
 
-            g_free(filename);
-        } while (gtk_tree_model_iter_next(model, &iter));
+        /* Create the preview image */
+        xfdesktop_settings_add_file_to_queue(background_settings, &iter, src_file, thumb_file);
     }
+    g_free(key);
 }
 
 static void
@@ -414,42 +830,30 @@ xfdesktop_settings_queue_preview(GtkTreeModel *model,
     /* Attempt to use the thumbnailer if possible */
     if (!xfdesktop_thumbnailer_queue_thumbnail(background_settings->thumbnailer, filename)) {
         /* Thumbnailing not possible, add it to the queue to be loaded manually */
-        PreviewData *pdata;
-        pdata = g_new0(PreviewData, 1);
-        pdata->model = g_object_ref(model);
-        pdata->iter = gtk_tree_iter_copy(iter);
-        pdata->scale_factor = gtk_widget_get_scale_factor(GTK_WIDGET(background_settings->image_iconview));
-
         XF_DEBUG("Thumbnailing failed, adding %s manually.", filename);
-        xfdesktop_settings_add_file_to_queue(background_settings, pdata);
+        xfdesktop_settings_add_file_to_queue(background_settings, iter, filename, NULL);
     }
 
     g_free(filename);
 }
 
 
-static gint
-image_list_compare(GtkTreeModel *model, const gchar *a, GtkTreeIter *b) {
-    gchar *key_b = NULL;
-    gtk_tree_model_get(model, b, COL_COLLATE_KEY, &key_b, -1);
-
-    gint ret = g_strcmp0(a, key_b);
-
-    g_free(key_b);
-
-    return ret;
+static void
+image_list_entry_free(ImageListEntry *entry) {
+    g_free(entry->collate_key);
+    g_free(entry->name_markup);
+    g_object_unref(entry->file);
+    g_free(entry);
 }
 
-static GtkTreeIter *
-xfdesktop_settings_image_iconview_add(GtkListStore *model,
-                                      GFile *file,
-                                      GFileInfo *info,
-                                      XfdesktopBackgroundSettings *background_settings)
-{
-    gboolean added = FALSE;
-    GtkTreeIter iter;
+static ImageListEntry *
+image_list_entry_new(GFile *file, GFileInfo *info) {
+    ImageListEntry *entry = NULL;
 
-    if (xfdesktop_file_has_media_mime_type(file)) {
+    /* The enumerator already figured out the content type for us, so there's
+     * no need to query the file again */
+    const gchar *content_type = g_file_info_get_content_type(info);
+    if (xfdesktop_mime_type_is_media(content_type)) {
         gchar *name = g_file_get_basename(file);
         if (name != NULL) {
             guint name_length = strlen(name);
@@ -458,45 +862,20 @@ xfdesktop_settings_image_iconview_add(GtkListStore *model,
                 goffset file_size = g_file_info_get_size(info);
                 gchar *size_string = g_format_size(file_size);
 
+                entry = g_new0(ImageListEntry, 1);
+                entry->file = g_object_ref(file);
+
                 /* Display the file name, file type, and file size in the tooltip. */
-                const gchar *content_type = g_file_info_get_content_type(info);
-                gchar *name_markup = g_markup_printf_escaped(_("<b>%s</b>\nType: %s\nSize: %s"),
+                entry->name_markup = g_markup_printf_escaped(_("<b>%s</b>\nType: %s\nSize: %s"),
                                                              name_utf8,
                                                              content_type,
                                                              size_string);
 
                 /* create a case sensitive collation key for sorting filenames like
                  * Thunar does */
-                gchar *collate_key = g_utf8_collate_key_for_filename(name, name_length);
-
-                /* Insert sorted */
-                GtkTreeIter search_iter;
-                gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(model), &search_iter);
-                gboolean found = FALSE;
-                gint position = 0;
-                while (valid && !found) {
-                    if (image_list_compare(GTK_TREE_MODEL(model), collate_key, &search_iter) <= 0) {
-                        found = TRUE;
-                    } else {
-                        valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(model), &search_iter);
-                        position++;
-                    }
-                }
+                entry->collate_key = g_utf8_collate_key_for_filename(name, name_length);
 
-                gtk_list_store_insert_with_values(model,
-                                                  &iter,
-                                                  position,
-                                                  COL_NAME, name_markup,
-                                                  COL_FILENAME, g_file_peek_path(file),
-                                                  COL_COLLATE_KEY, collate_key,
-                                                  -1);
-                xfdesktop_settings_queue_preview(GTK_TREE_MODEL(model), &iter, background_settings);
-
-                added = TRUE;
-
-                g_free(name_markup);
                 g_free(size_string);
-                g_free(collate_key);
             }
 
             g_free(name_utf8);
@@ -505,13 +884,514 @@ xfdesktop_settings_image_iconview_add(GtkListStore *model,
         g_free(name);
     }
 
-    if (added) {
-        return gtk_tree_iter_copy(&iter);
+    return entry;
+}
+
+static gint
+image_list_entry_compare(gconstpointer a, gconstpointer b) {
+    const ImageListEntry *entry_a = *(ImageListEntry **)a;
+    const ImageListEntry *entry_b = *(ImageListEntry **)b;
+    return g_strcmp0(entry_a->collate_key, entry_b->collate_key);
+}
+
+/* Returns the index of the first key in @keys, starting at @lower, that sorts
+ * at or after @key. */
+static guint
+image_list_find_position(GPtrArray *keys, const gchar *key, guint lower) {
+    guint upper = keys->len;
+
+    while (lower < upper) {
+        guint mid = lower + (upper - lower) / 2;
+        if (g_strcmp0(g_ptr_array_index(keys, mid), key) < 0) {
+            lower = mid + 1;
+        } else {
+            upper = mid;
+        }
+    }
+
+    return lower;
+}
+
+/* The same key image_list_entry_new() would create for @filename. */
+static gchar *
+image_list_collate_key(const gchar *filename) {
+    gchar *name = g_path_get_basename(filename);
+    gchar *key = name != NULL ? g_utf8_collate_key_for_filename(name, strlen(name)) : NULL;
+    g_free(name);
+    return key;
+}
+
+/* Finds the row for @filename, whose collation key is @key. */
+static gboolean
+image_list_find_file(GtkListStore *model,
+                     GPtrArray *keys,
+                     const gchar *key,
+                     const gchar *filename,
+                     GtkTreeIter *iter_out,
+                     guint *position_out)
+{
+    for (guint i = image_list_find_position(keys, key, 0);
+         i < keys->len && g_strcmp0(g_ptr_array_index(keys, i), key) == 0;
+         ++i)
+    {
+        GtkTreeIter iter;
+        if (gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(model), &iter, NULL, i)) {
+            gchar *row_filename = NULL;
+            gtk_tree_model_get(GTK_TREE_MODEL(model), &iter, COL_FILENAME, &row_filename, -1);
+            gboolean found = g_strcmp0(row_filename, filename) == 0;
+            g_free(row_filename);
+
+            if (found) {
+                if (iter_out != NULL) {
+                    *iter_out = iter;
+                }
+                if (position_out != NULL) {
+                    *position_out = i;
+                }
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/* Merges a batch of entries into the (already sorted) model.  Takes ownership
+ * of @entries.  Returns a copy of the iter of the row for @last_image, if it
+ * was part of this batch. */
+static GtkTreeIter *
+xfdesktop_settings_image_iconview_add_batch(XfdesktopBackgroundSettings *background_settings,
+                                            GPtrArray *entries,
+                                            const gchar *last_image)
+{
+    GtkListStore *model = background_settings->preview_model;
+    GPtrArray *keys = background_settings->preview_collate_keys;
+    GtkTreeIter *selected_iter = NULL;
+    guint lower = 0;
+
+    /* Since the batch is sorted, each entry's insertion point can't be before
+     * the previous one's, which narrows down each search */
+    g_ptr_array_sort(entries, image_list_entry_compare);
+
+    for (guint i = 0; i < entries->len; ++i) {
+        ImageListEntry *entry = g_ptr_array_index(entries, i);
+        guint position = image_list_find_position(keys, entry->collate_key, lower);
+        GtkTreeIter iter;
+
+        gtk_list_store_insert_with_values(model,
+                                          &iter,
+                                          position,
+                                          COL_NAME, entry->name_markup,
+                                          COL_FILENAME, g_file_peek_path(entry->file),
+                                          -1);
+        g_ptr_array_insert(keys, position, entry->collate_key);
+        entry->collate_key = NULL;
+        lower = position + 1;
+        background_settings->preview_order_stale = TRUE;
+
+        xfdesktop_settings_queue_preview(GTK_TREE_MODEL(model), &iter, background_settings);
+
+        if (selected_iter == NULL && g_strcmp0(g_file_peek_path(entry->file), last_image) == 0) {
+            selected_iter = gtk_tree_iter_copy(&iter);
+        }
+    }
+
+    g_ptr_array_unref(entries);
+
+    return selected_iter;
+}
+
+static void
+clear_preview_model(XfdesktopBackgroundSettings *background_settings) {
+    g_clear_object(&background_settings->preview_model);
+    if (background_settings->preview_collate_keys != NULL) {
+        g_ptr_array_unref(background_settings->preview_collate_keys);
+        background_settings->preview_collate_keys = NULL;
+    }
+}
+
+/* Queues previews for every row of the current model that doesn't have one,
+ * e.g. because loading was interrupted when the folder was last shown. */
+static void
+xfdesktop_settings_queue_missing_previews(XfdesktopBackgroundSettings *background_settings) {
+    GtkTreeModel *model = GTK_TREE_MODEL(background_settings->preview_model);
+    GtkTreeIter iter;
+
+    if (gtk_tree_model_get_iter_first(model, &iter)) {
+        do {
+            cairo_surface_t *surface = NULL;
+            gtk_tree_model_get(model, &iter, COL_SURFACE, &surface, -1);
+            if (surface != NULL) {
+                cairo_surface_destroy(surface);
+            } else {
+                xfdesktop_settings_queue_preview(model, &iter, background_settings);
+            }
+        } while (gtk_tree_model_iter_next(model, &iter));
+    }
+}
+
+static void
+folder_change_free(FolderChange *change) {
+    g_object_unref(change->file);
+    g_free(change);
+}
+
+static void
+folder_cache_entry_free(FolderCacheEntry *entry) {
+    g_cancellable_cancel(entry->cancellable);
+    g_object_unref(entry->cancellable);
+    if (entry->monitor != NULL) {
+        g_signal_handlers_disconnect_by_data(entry->monitor, entry);
+        g_file_monitor_cancel(entry->monitor);
+        g_object_unref(entry->monitor);
+    }
+    g_list_free_full(entry->pending_changes, (GDestroyNotify)folder_change_free);
+    g_hash_table_destroy(entry->created_files);
+    g_object_unref(entry->model);
+    g_ptr_array_unref(entry->collate_keys);
+    g_object_unref(entry->folder);
+    g_free(entry);
+}
+
+static void
+folder_cache_remove(XfdesktopBackgroundSettings *background_settings, FolderCacheEntry *entry) {
+    background_settings->folder_cache = g_list_remove(background_settings->folder_cache, entry);
+    folder_cache_entry_free(entry);
+}
+
+static gboolean
+folder_cache_entry_is_current(FolderCacheEntry *entry) {
+    return entry->model == entry->background_settings->preview_model;
+}
+
+/* Adds a row for @image, or if it's already listed (found by the enumerator,
+ * or rewritten since), refreshes that one row. */
+static void
+folder_cache_insert_image(FolderCacheEntry *entry, ImageListEntry *image) {
+    XfdesktopBackgroundSettings *background_settings = entry->background_settings;
+    const gchar *filename = g_file_peek_path(image->file);
+    gboolean current = folder_cache_entry_is_current(entry);
+    GtkTreeIter iter;
+
+    if (image_list_find_file(entry->model, entry->collate_keys, image->collate_key, filename, &iter, NULL)) {
+        if (current) {
+            xfdesktop_settings_drop_queued_previews(background_settings, &iter);
+        }
+        gtk_list_store_set(entry->model, &iter,
+                           COL_PIX, NULL,
+                           COL_SURFACE, NULL,
+                           COL_NAME, image->name_markup,
+                           COL_THUMBNAIL, NULL,
+                           -1);
     } else {
-        return NULL;
+        guint position = image_list_find_position(entry->collate_keys, image->collate_key, 0);
+
+        gtk_list_store_insert_with_values(entry->model,
+                                          &iter,
+                                          position,
+                                          COL_NAME, image->name_markup,
+                                          COL_FILENAME, filename,
+                                          -1);
+        g_ptr_array_insert(entry->collate_keys, position, image->collate_key);
+        image->collate_key = NULL;
+
+        if (current) {
+            background_settings->preview_order_stale = TRUE;
+        }
+    }
+
+    // Other folders get their previews when they're shown again.
+    if (current) {
+        xfdesktop_settings_queue_preview(GTK_TREE_MODEL(entry->model), &iter, background_settings);
+    }
+}
+
+static void
+folder_cache_file_info_ready(GObject *source, GAsyncResult *res, gpointer user_data) {
+    GFile *file = G_FILE(source);
+
+    GError *error = NULL;
+    GFileInfo *info = g_file_query_info_finish(file, res, &error);
+    if (info == NULL) {
+        // Cancelled means the entry is gone.
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            XF_DEBUG("Unable to query new file %s: %s", g_file_peek_path(file), error->message);
+        }
+        g_error_free(error);
+    } else {
+        FolderCacheEntry *entry = user_data;
+        ImageListEntry *image = image_list_entry_new(file, info);
+        if (image != NULL) {
+            folder_cache_insert_image(entry, image);
+            image_list_entry_free(image);
+        }
+        g_object_unref(info);
     }
 }
 
+static void
+folder_cache_file_added(FolderCacheEntry *entry, GFile *file) {
+    g_file_query_info_async(file,
+                            XFDESKTOP_FILE_INFO_NAMESPACE,
+                            G_FILE_QUERY_INFO_NONE,
+                            G_PRIORITY_DEFAULT,
+                            entry->cancellable,
+                            folder_cache_file_info_ready,
+                            entry);
+}
+
+static void
+folder_cache_file_removed(FolderCacheEntry *entry, GFile *file) {
+    const gchar *filename = g_file_peek_path(file);
+    gchar *key = filename != NULL ? image_list_collate_key(filename) : NULL;
+    GtkTreeIter iter;
+    guint position;
+
+    if (key != NULL && image_list_find_file(entry->model, entry->collate_keys, key, filename, &iter, &position)) {
+        if (folder_cache_entry_is_current(entry)) {
+            /* Queued previews hold on to their row's iter, which is about to
+             * become invalid */
+            xfdesktop_settings_drop_queued_previews(entry->background_settings, &iter);
+            entry->background_settings->preview_order_stale = TRUE;
+        }
+
+        gtk_list_store_remove(entry->model, &iter);
+        g_ptr_array_remove_index(entry->collate_keys, position);
+    }
+
+    g_free(key);
+}
+
+static void
+folder_cache_file_changed(FolderCacheEntry *entry, GFile *file, gboolean added) {
+    if (file == NULL) {
+        return;
+    }
+
+    if (!entry->complete) {
+        FolderChange *change = g_new0(FolderChange, 1);
+        change->file = g_object_ref(file);
+        change->added = added;
+        entry->pending_changes = g_list_prepend(entry->pending_changes, change);
+    } else if (added) {
+        folder_cache_file_added(entry, file);
+    } else {
+        folder_cache_file_removed(entry, file);
+    }
+}
+
+static void
+cb_folder_cache_monitor_changed(GFileMonitor *monitor,
+                                GFile *file,
+                                GFile *other_file,
+                                GFileMonitorEvent event,
+                                FolderCacheEntry *entry)
+{
+    switch (event) {
+        case G_FILE_MONITOR_EVENT_CREATED:
+            /* It may still be being written, so wait for the
+             * CHANGES_DONE_HINT, which local monitors always send (after a
+             * short delay, if the backend doesn't know when writing ends) */
+            g_hash_table_add(entry->created_files, g_object_ref(file));
+            break;
+
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+            folder_cache_file_changed(entry, file, TRUE);
+            break;
+
+        case G_FILE_MONITOR_EVENT_DELETED:
+        case G_FILE_MONITOR_EVENT_MOVED_OUT:
+            g_hash_table_remove(entry->created_files, file);
+            folder_cache_file_changed(entry, file, FALSE);
+            break;
+
+        case G_FILE_MONITOR_EVENT_RENAMED:
+            g_hash_table_remove(entry->created_files, file);
+            folder_cache_file_changed(entry, file, FALSE);
+            folder_cache_file_changed(entry, other_file, TRUE);
+            break;
+
+        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+            /* Either a new file is finished, or an existing one was
+             * rewritten; adding it again refreshes its row in place */
+            g_hash_table_remove(entry->created_files, file);
+            folder_cache_file_changed(entry, file, TRUE);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Creates a cache entry for @folder, which is about to be enumerated, and
+ * makes it the current folder's. */
+static FolderCacheEntry *
+folder_cache_add(XfdesktopBackgroundSettings *background_settings, GFile *folder) {
+    for (GList *l = background_settings->folder_cache; l != NULL;) {
+        FolderCacheEntry *old_entry = l->data;
+        l = l->next;
+        if (g_file_equal(old_entry->folder, folder)) {
+            folder_cache_remove(background_settings, old_entry);
+        }
+    }
+
+    FolderCacheEntry *entry = g_new0(FolderCacheEntry, 1);
+    entry->background_settings = background_settings;
+    entry->folder = g_object_ref(folder);
+    entry->model = gtk_list_store_new(N_COLS,
+                                      GDK_TYPE_PIXBUF,
+                                      CAIRO_GOBJECT_TYPE_SURFACE,
+                                      G_TYPE_STRING,
+                                      G_TYPE_STRING,
+                                      G_TYPE_STRING);
+    entry->collate_keys = g_ptr_array_new_with_free_func(g_free);
+    entry->cancellable = g_cancellable_new();
+    entry->created_files = g_hash_table_new_full(g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
+
+    /* Start watching before enumerating, so nothing slips through in
+     * between */
+    GError *error = NULL;
+    entry->monitor = g_file_monitor_directory(folder, G_FILE_MONITOR_WATCH_MOVES, entry->cancellable, &error);
+    if (entry->monitor != NULL) {
+        g_signal_connect(entry->monitor, "changed",
+                         G_CALLBACK(cb_folder_cache_monitor_changed), entry);
+    } else {
+        XF_DEBUG("Unable to monitor %s: %s", g_file_peek_path(folder), error->message);
+        g_error_free(error);
+    }
+
+    background_settings->folder_cache = g_list_prepend(background_settings->folder_cache, entry);
+
+    clear_preview_model(background_settings);
+    background_settings->preview_model = g_object_ref(entry->model);
+    background_settings->preview_collate_keys = g_ptr_array_ref(entry->collate_keys);
+
+    return entry;
+}
+
+/* Only returns folders that have been fully enumerated. */
+static FolderCacheEntry *
+folder_cache_lookup(XfdesktopBackgroundSettings *background_settings, GFile *folder) {
+    for (GList *l = background_settings->folder_cache; l != NULL; l = l->next) {
+        FolderCacheEntry *entry = l->data;
+        if (entry->complete && g_file_equal(entry->folder, folder)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Entries that never finished loading can't be used, and without a running
+ * enumeration, never will be. */
+static void
+folder_cache_remove_incomplete(XfdesktopBackgroundSettings *background_settings) {
+    for (GList *l = background_settings->folder_cache; l != NULL;) {
+        FolderCacheEntry *entry = l->data;
+        l = l->next;
+        if (!entry->complete) {
+            folder_cache_remove(background_settings, entry);
+        }
+    }
+}
+
+/* Drops the least recently used folders until the cache is within its
+ * limits.  The current folder always stays, however large it is. */
+static void
+folder_cache_trim(XfdesktopBackgroundSettings *background_settings) {
+    guint n_folders = 0;
+    gint n_images = 0;
+
+    for (GList *l = background_settings->folder_cache; l != NULL;) {
+        FolderCacheEntry *entry = l->data;
+        gint entry_images = gtk_tree_model_iter_n_children(GTK_TREE_MODEL(entry->model), NULL);
+        gboolean first = l == background_settings->folder_cache;
+        l = l->next;
+
+        if (!first && (n_folders + 1 > FOLDER_CACHE_MAX_FOLDERS || n_images + entry_images > FOLDER_CACHE_MAX_IMAGES)) {
+            XF_DEBUG("dropping cached folder %s", g_file_peek_path(entry->folder));
+            folder_cache_remove(background_settings, entry);
+        } else {
+            n_folders++;
+            n_images += entry_images;
+        }
+    }
+}
+
+/* Called once the current folder has been enumerated. */
+static void
+folder_cache_complete(XfdesktopBackgroundSettings *background_settings) {
+    FolderCacheEntry *entry = background_settings->folder_cache != NULL ? background_settings->folder_cache->data : NULL;
+    if (entry == NULL || !folder_cache_entry_is_current(entry)) {
+        return;
+    }
+
+    entry->complete = TRUE;
+
+    GList *changes = g_list_reverse(g_steal_pointer(&entry->pending_changes));
+    for (GList *l = changes; l != NULL; l = l->next) {
+        FolderChange *change = l->data;
+        folder_cache_file_changed(entry, change->file, change->added);
+    }
+    g_list_free_full(changes, (GDestroyNotify)folder_change_free);
+
+    folder_cache_trim(background_settings);
+}
+
+/* Shows the fully loaded image list in the icon view, selecting
+ * @selected_iter if it's not %NULL. */
+static void
+xfdesktop_settings_show_image_list(XfdesktopBackgroundSettings *background_settings, GtkTreeIter *selected_iter) {
+    gtk_icon_view_set_model(GTK_ICON_VIEW(background_settings->image_iconview),
+                            GTK_TREE_MODEL(background_settings->preview_model));
+
+    if (selected_iter != NULL) {
+        GtkTreePath *path = gtk_tree_model_get_path(GTK_TREE_MODEL(background_settings->preview_model),
+                                                    selected_iter);
+        gtk_icon_view_select_path(GTK_ICON_VIEW(background_settings->image_iconview), path);
+        gtk_tree_path_free(path);
+    } else {
+        gchar *prop_name = xfdesktop_settings_generate_per_workspace_binding_string(background_settings, "backdrop-cycle-enable");
+        gboolean backdrop_cycle_enable = xfconf_channel_get_bool(background_settings->settings->channel, prop_name, FALSE);
+
+        if (backdrop_cycle_enable) {
+            gtk_widget_show(background_settings->btn_folder_apply);
+        }
+
+        g_free(prop_name);
+    }
+}
+
+/* Switches back to a folder we've already loaded, without enumerating it
+ * again. */
+static void
+folder_cache_restore(XfdesktopBackgroundSettings *background_settings, FolderCacheEntry *entry) {
+    TRACE("entering");
+
+    background_settings->folder_cache = g_list_remove(background_settings->folder_cache, entry);
+    background_settings->folder_cache = g_list_prepend(background_settings->folder_cache, entry);
+
+    if (background_settings->selected_folder != NULL) {
+        g_object_unref(background_settings->selected_folder);
+    }
+    background_settings->selected_folder = g_object_ref(entry->folder);
+
+    gtk_icon_view_set_model(GTK_ICON_VIEW(background_settings->image_iconview), NULL);
+    clear_preview_model(background_settings);
+    background_settings->preview_model = g_object_ref(entry->model);
+    background_settings->preview_collate_keys = g_ptr_array_ref(entry->collate_keys);
+
+    /* Previews that were still loading when we switched away were dropped */
+    xfdesktop_settings_queue_missing_previews(background_settings);
+
+    gchar *last_image = xfdesktop_settings_get_backdrop_image(background_settings);
+    gchar *key = last_image != NULL ? image_list_collate_key(last_image) : NULL;
+    GtkTreeIter iter;
+    gboolean found = key != NULL && image_list_find_file(entry->model, entry->collate_keys, key, last_image, &iter, NULL);
+    xfdesktop_settings_show_image_list(background_settings, found ? &iter : NULL);
+    g_free(key);
+    g_free(last_image);
+}
+
 static void
 dir_data_free(AddDirData *dir_data) {
     XfdesktopBackgroundSettings *background_settings = dir_data->background_settings;
@@ -550,46 +1430,27 @@ cb_enumerator_file_ready(GObject *source, GAsyncResult *res, gpointer user_data)
                                    _("Unable to load images from folder \"%s\""),
                                    g_file_peek_path(background_settings->selected_folder));
             g_error_free(error);
+            /* When cancelled, stop_image_loading() already did this, and a
+             * new folder may be loading by now */
+            folder_cache_remove_incomplete(background_settings);
         }
         xfdesktop_thumbnailer_dequeue_all_thumbnails(dir_data->background_settings->thumbnailer);
-        g_clear_object(&background_settings->preview_model);
+        clear_preview_model(background_settings);
         dir_data_free(dir_data);
     } else if (file_infos == NULL) {
-        gtk_icon_view_set_model(GTK_ICON_VIEW(background_settings->image_iconview),
-                                GTK_TREE_MODEL(background_settings->preview_model));
-
-        if (dir_data->selected_iter != NULL) {
-            GtkTreePath *path = gtk_tree_model_get_path(GTK_TREE_MODEL(background_settings->preview_model),
-                                                        dir_data->selected_iter);
-            gtk_icon_view_select_path(GTK_ICON_VIEW(background_settings->image_iconview), path);
-            gtk_tree_path_free(path);
-        } else {
-            gchar *prop_name = xfdesktop_settings_generate_per_workspace_binding_string(background_settings, "backdrop-cycle-enable");
-            gboolean backdrop_cycle_enable = xfconf_channel_get_bool(background_settings->settings->channel, prop_name, FALSE);
-
-            if (backdrop_cycle_enable) {
-                gtk_widget_show(background_settings->btn_folder_apply);
-            }
-
-            g_free(prop_name);
-        }
-
+        xfdesktop_settings_show_image_list(background_settings, dir_data->selected_iter);
+        folder_cache_complete(background_settings);
         dir_data_free(dir_data);
     } else {
+        GPtrArray *entries = g_ptr_array_new_with_free_func((GDestroyNotify)image_list_entry_free);
+
         for (GList *l = file_infos; l != NULL; l = l->next) {
             GFileInfo *info = G_FILE_INFO(l->data);
             GFile *file = g_file_enumerator_get_child(dir_data->file_enumerator, info);
 
-            GtkTreeIter *iter = xfdesktop_settings_image_iconview_add(background_settings->preview_model,
-                                                                      file,
-                                                                      info,
-                                                                      background_settings);
-            if (iter != NULL) {
-                if (dir_data->selected_iter == NULL && g_strcmp0(g_file_peek_path(file), dir_data->last_image) == 0) {
-                    dir_data->selected_iter = iter;
-                } else {
-                    gtk_tree_iter_free(iter);
-                }
+            ImageListEntry *entry = image_list_entry_new(file, info);
+            if (entry != NULL) {
+                g_ptr_array_add(entries, entry);
             }
 
             g_object_unref(file);
@@ -597,8 +1458,20 @@ cb_enumerator_file_ready(GObject *source, GAsyncResult *res, gpointer user_data)
         }
         g_list_free(file_infos);
 
+        GtkTreeIter *iter = xfdesktop_settings_image_iconview_add_batch(background_settings,
+                                                                        entries,
+                                                                        dir_data->selected_iter == NULL
+                                                                        ? dir_data->last_image
+                                                                        : NULL);
+        if (iter != NULL) {
+            dir_data->selected_iter = iter;
+        }
+
+        /* Start small so the first images show up quickly, then ramp up to
+         * cut down on round trips for large folders */
+        dir_data->batch_size = MIN(dir_data->batch_size * 2, ENUMERATION_BATCH_SIZE_MAX);
         g_file_enumerator_next_files_async(dir_data->file_enumerator,
-                                           5,
+                                           dir_data->batch_size,
                                            G_PRIORITY_DEFAULT_IDLE,
                                            background_settings->cancel_enumeration,
                                            cb_enumerator_file_ready,
@@ -630,28 +1503,20 @@ xfdesktop_image_list_add_dir(GObject *source_object, GAsyncResult *res, gpointer
                                _("Unable to load images from folder \"%s\""),
                                g_file_peek_path(new_folder));
 
-        g_object_unref(new_folder);
         g_error_free(error);
     } else {
         if (background_settings->selected_folder != NULL) {
             g_object_unref(background_settings->selected_folder);
         }
-        background_settings->selected_folder = new_folder;
+        background_settings->selected_folder = g_object_ref(new_folder);
 
         AddDirData *dir_data = g_new0(AddDirData, 1);
         dir_data->background_settings = background_settings;
         dir_data->file_enumerator = enumerator;
+        dir_data->batch_size = ENUMERATION_BATCH_SIZE_MIN;
 
-        g_clear_object(&background_settings->preview_model);
         gtk_icon_view_set_model(GTK_ICON_VIEW(background_settings->image_iconview), NULL);
-
-        background_settings->preview_model = gtk_list_store_new(N_COLS,
-                                                                GDK_TYPE_PIXBUF,
-                                                                CAIRO_GOBJECT_TYPE_SURFACE,
-                                                                G_TYPE_STRING,
-                                                                G_TYPE_STRING,
-                                                                G_TYPE_STRING,
-                                                                G_TYPE_STRING);
+        folder_cache_add(background_settings, new_folder);
 
         /* Get the last image/current image displayed so we can select it in the
          * icon view */
@@ -659,7 +1524,7 @@ xfdesktop_image_list_add_dir(GObject *source_object, GAsyncResult *res, gpointer
         dir_data->file_path = g_file_get_path(background_settings->selected_folder);
 
         g_file_enumerator_next_files_async(dir_data->file_enumerator,
-                                           5,
+                                           dir_data->batch_size,
                                            G_PRIORITY_DEFAULT_IDLE,
                                            background_settings->cancel_enumeration,
                                            cb_enumerator_file_ready,
@@ -980,17 +1845,9 @@ stop_image_loading(XfdesktopBackgroundSettings *background_settings) {
     /* stop any thumbnailing in progress */
     xfdesktop_thumbnailer_dequeue_all_thumbnails(background_settings->thumbnailer);
 
-    /* stop the idle preview callback */
-    if (background_settings->preview_id != 0) {
-        g_source_remove(background_settings->preview_id);
-        background_settings->preview_id = 0;
-    }
-
-    /* Remove the previews in the message queue */
-    if (background_settings->preview_queue != NULL) {
-        g_async_queue_unref(background_settings->preview_queue);
-        background_settings->preview_queue = NULL;
-    }
+    /* Invalidate any previews still queued or being decoded; the workers
+     * will skip them, and the main thread will drop their results */
+    g_atomic_int_inc(&background_settings->preview_generation);
 
     /* Cancel any file enumeration that's running */
     if (background_settings->cancel_enumeration != NULL) {
@@ -1004,6 +1861,9 @@ stop_image_loading(XfdesktopBackgroundSettings *background_settings) {
         g_source_remove(background_settings->add_dir_idle_id);
         background_settings->add_dir_idle_id = 0;
     }
+
+    /* A folder that was only partly loaded can't be reused */
+    folder_cache_remove_incomplete(background_settings);
 }
 
 static gboolean
@@ -1042,9 +1902,20 @@ update_icon_view_model(XfdesktopBackgroundSettings *background_settings) {
     /* Stop any previous loading since something changed */
     stop_image_loading(background_settings);
 
+    GFile *folder = g_file_new_for_path(new_folder);
+    FolderCacheEntry *entry = folder_cache_lookup(background_settings, folder);
+    if (entry != NULL) {
+        XF_DEBUG("using cached image list for %s", new_folder);
+        folder_cache_restore(background_settings, entry);
+        g_object_unref(folder);
+        g_free(new_folder);
+        g_free(previous_folder);
+        return TRUE;
+    }
+
     background_settings->cancel_enumeration = g_cancellable_new();
 
-    g_file_enumerate_children_async(g_file_new_for_path(new_folder),
+    g_file_enumerate_children_async(folder,
                                     XFDESKTOP_FILE_INFO_NAMESPACE,
                                     G_FILE_QUERY_INFO_NONE,
                                     G_PRIORITY_DEFAULT,
@@ -1052,6 +1923,7 @@ update_icon_view_model(XfdesktopBackgroundSettings *background_settings) {
                                     xfdesktop_image_list_add_dir,
                                     background_settings);
 
+    g_object_unref(folder);
     g_free(new_folder);
     g_free(previous_folder);
 
@@ -2005,6 +2877,17 @@ xfdesktop_background_settings_init(XfdesktopSettings *settings) {
     background_settings->image_iconview = GTK_WIDGET(gtk_builder_get_object(appearance_gxml, "iconview_imagelist"));
     xfdesktop_settings_setup_image_iconview(background_settings);
 
+    background_settings->preview_queue = g_async_queue_new_full((GDestroyNotify)xfdesktop_settings_free_pdata);
+    background_settings->previews_pending = g_hash_table_new(g_direct_hash, g_direct_equal);
+    background_settings->preview_visible_start = -1;
+    background_settings->preview_visible_end = -1;
+    background_settings->preview_pool = g_thread_pool_new(xfdesktop_settings_do_single_preview,
+                                                          background_settings,
+                                                          CLAMP((gint)g_get_num_processors() - 1, 1, PREVIEW_MAX_THREADS),
+                                                          FALSE,
+                                                          NULL);
+    g_thread_pool_set_sort_function(background_settings->preview_pool, preview_data_compare, NULL);
+
     // We create the file chooser button manually because GTK has a weird bug that makes
     // it so if the user sets a folder on the button, we can't change it programmatially
     // later (for instance, if they pick an inaccessible folder, we want to revert it to
@@ -2029,14 +2912,7 @@ xfdesktop_background_settings_init(XfdesktopSettings *settings) {
     gtk_file_chooser_button_set_title(GTK_FILE_CHOOSER_BUTTON(background_settings->btn_folder), _("Select a Directory"));
 
     /* Get default wallpaper folders */
-    GList *background_dirs = find_background_directories();
-    for (GList *l = background_dirs; l != NULL; l = l->next) {
-        GFile *file = G_FILE(l->data);
-        gchar *uri_path = g_file_get_uri(file);
-        gtk_file_chooser_add_shortcut_folder_uri(GTK_FILE_CHOOSER(background_settings->btn_folder), uri_path, NULL);
-        g_free(uri_path);
-    }
-    g_list_free_full(background_dirs, g_object_unref);
+    start_background_directory_discovery(background_settings);
 
     /* Image and color style options */
     background_settings->image_style_combo = GTK_WIDGET(gtk_builder_get_object(appearance_gxml, "combo_style"));
@@ -2108,6 +2984,16 @@ xfdesktop_background_settings_destroy(XfdesktopBackgroundSettings *background_se
                                     background_settings->last_image_signal_id);
     }
     stop_image_loading(background_settings);
+    stop_background_directory_discovery(background_settings);
+    /* Everything left in the pool is stale now, so this doesn't take long */
+    g_thread_pool_free(background_settings->preview_pool, FALSE, TRUE);
+    if (background_settings->preview_id != 0) {
+        g_source_remove(background_settings->preview_id);
+    }
+    g_async_queue_unref(background_settings->preview_queue);
+    g_hash_table_destroy(background_settings->previews_pending);
+    clear_preview_model(background_settings);
+    g_list_free_full(background_settings->folder_cache, (GDestroyNotify)folder_cache_entry_free);
     g_free(background_settings->monitor_name);
     g_object_unref(background_settings->xfw_screen);
     g_free(background_settings);
@@ -31,6 +31,7 @@
 #include <libxfce4windowing/libxfce4windowing.h>
 
 #include "xfdesktop-application.h"
+#include "xfdesktop-startup-trace.h"
 
 #ifdef ENABLE_FILE_ICONS
 #include "xfdesktop-monitor-chooser-ui.h"
@@ -42,10 +43,14 @@ main(int argc, char **argv)
     XfdesktopApplication *app;
     int ret = 0;
 
+    xfdesktop_startup_trace_init();
+
     /* bind gettext textdomain */
     xfce_textdomain(GETTEXT_PACKAGE, LOCALEDIR, "UTF-8");
 
+    xfdesktop_startup_trace_begin("gtk-init");
     gtk_init(&argc, &argv);
+    xfdesktop_startup_trace_end("gtk-init");
 
 #ifdef ENABLE_FILE_ICONS
     xfdesktop_monitor_chooser_ui_register_resource();
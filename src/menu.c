@@ -40,10 +40,104 @@
 #endif
 
 #ifdef ENABLE_DESKTOP_MENU
+#define PREWARM_DELAY_S 2
+
 static gboolean inited = FALSE;
 static gboolean show_desktop_menu = TRUE;
 static gboolean show_desktop_menu_icons = TRUE;
 static GarconMenu *garcon_menu = NULL;
+
+/* the apps menu, built ahead of time so popping it up is cheap.  When the
+ * installed applications change, garcon-gtk reloads it on its own. */
+static GtkWidget *prewarmed_menu = NULL;
+static guint prewarm_id = 0;
+
+static void schedule_prewarm(void);
+
+static void
+prewarmed_menu_destroyed(GtkWidget *widget, gpointer user_data)
+{
+    if (widget == prewarmed_menu) {
+        prewarmed_menu = NULL;
+        g_object_unref(widget);
+        schedule_prewarm();
+    }
+}
+
+static void
+drop_prewarmed_menu(void)
+{
+    if (prewarmed_menu != NULL) {
+        GtkWidget *widget = prewarmed_menu;
+        prewarmed_menu = NULL;
+        g_signal_handlers_disconnect_by_func(widget, prewarmed_menu_destroyed, NULL);
+        gtk_widget_destroy(widget);
+        g_object_unref(widget);
+    }
+}
+
+static GtkWidget *
+build_desktop_menu(void)
+{
+    /* init garcon environment */
+    garcon_set_environment_xdg(GARCON_ENVIRONMENT_XFCE);
+
+    if(garcon_menu == NULL) {
+        garcon_menu = garcon_menu_new_applications();
+    }
+
+    GtkWidget *desktop_menu = g_object_new(GARCON_GTK_TYPE_MENU,
+                                           "show-menu-icons", show_desktop_menu_icons,
+                                           "menu", garcon_menu,
+                                           NULL);
+    XF_DEBUG("show desktop menu icons %s", show_desktop_menu_icons ? "TRUE" : "FALSE");
+
+    /* showing forces garcon-gtk to parse the menu and create all the items
+     * (and their icons) right away, instead of on first popup */
+    gtk_widget_show(desktop_menu);
+
+    return desktop_menu;
+}
+
+static gboolean
+prewarm_menu(gpointer user_data)
+{
+    prewarm_id = 0;
+
+    if (!show_desktop_menu) {
+        return G_SOURCE_REMOVE;
+    }
+
+    if (prewarmed_menu == NULL) {
+        gint64 start = g_get_monotonic_time();
+
+        prewarmed_menu = g_object_ref(build_desktop_menu());
+        g_signal_connect(prewarmed_menu, "destroy",
+                         G_CALLBACK(prewarmed_menu_destroyed), NULL);
+
+        XF_DEBUG("prewarmed application menu in %.3fms", (g_get_monotonic_time() - start) / 1000.0);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_prewarm(void)
+{
+    if (inited && show_desktop_menu && prewarm_id == 0) {
+        prewarm_id = g_timeout_add_seconds_full(G_PRIORITY_LOW, PREWARM_DELAY_S, prewarm_menu, NULL, NULL);
+    }
+}
+
+static void
+submenu_item_destroyed(GtkWidget *mi, gpointer user_data)
+{
+    /* the item would take the prewarmed menu down with it otherwise, unless
+     * it's been moved to another item already */
+    if (prewarmed_menu != NULL && gtk_menu_item_get_submenu(GTK_MENU_ITEM(mi)) == prewarmed_menu) {
+        gtk_menu_item_set_submenu(GTK_MENU_ITEM(mi), NULL);
+    }
+}
 #endif
 
 GtkMenu *
@@ -57,17 +151,31 @@ menu_populate(GtkMenu *menu, gint scale_factor)
     if(!show_desktop_menu)
         return menu;
 
-    /* init garcon environment */
-    garcon_set_environment_xdg(GARCON_ENVIRONMENT_XFCE);
+    gint64 start = g_get_monotonic_time();
+    gboolean prewarmed = prewarmed_menu != NULL && !gtk_widget_get_mapped(prewarmed_menu);
 
-    if(garcon_menu == NULL) {
-        garcon_menu = garcon_menu_new_applications();
+    if (prewarmed) {
+        desktop_menu = prewarmed_menu;
+        /* the context menu it was last shown in may not have been destroyed
+         * yet, and a menu can only be attached to one widget at a time */
+        if (gtk_menu_get_attach_widget(GTK_MENU(desktop_menu)) != NULL) {
+            gtk_menu_detach(GTK_MENU(desktop_menu));
+        }
+        if (menu == NULL) {
+            /* the caller destroys a toplevel menu when it's done with it,
+             * so just hand it over and build a new one later */
+            g_signal_handlers_disconnect_by_func(desktop_menu, prewarmed_menu_destroyed, NULL);
+            prewarmed_menu = NULL;
+            /* our extra ref; its internal toplevel window still owns it */
+            g_object_unref(desktop_menu);
+            schedule_prewarm();
+        }
+    } else {
+        desktop_menu = build_desktop_menu();
+        if (prewarmed_menu == NULL) {
+            schedule_prewarm();
+        }
     }
-    desktop_menu = g_object_new(GARCON_GTK_TYPE_MENU,
-                                "show-menu-icons", show_desktop_menu_icons,
-                                "menu", garcon_menu,
-                                NULL);
-    XF_DEBUG("show desktop menu icons %s", show_desktop_menu_icons ? "TRUE" : "FALSE");
 
     // If we were provided a menu to populate, add the apps menu to a submenu
     if (menu != NULL) {
@@ -90,11 +198,23 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 G_GNUC_END_IGNORE_DEPRECATIONS
         }
         gtk_menu_item_set_submenu (GTK_MENU_ITEM(mi), desktop_menu);
+        if (desktop_menu == prewarmed_menu) {
+            g_signal_connect(mi, "destroy",
+                             G_CALLBACK(submenu_item_destroyed), NULL);
+        }
         gtk_widget_show(mi);
         gtk_menu_shell_append(GTK_MENU_SHELL(menu), mi);
 
+        XF_DEBUG("populated application menu in %.3fms (%s)",
+                 (g_get_monotonic_time() - start) / 1000.0,
+                 prewarmed ? "prewarmed" : "cold");
+
         return menu;
     } else {
+        XF_DEBUG("populated application menu in %.3fms (%s)",
+                 (g_get_monotonic_time() - start) / 1000.0,
+                 prewarmed ? "prewarmed" : "cold");
+
         return GTK_MENU(desktop_menu);
     }
 #else  /* !ENABLE_DESKTOP_MENU */
@@ -114,12 +234,22 @@ menu_settings_changed(XfconfChannel *channel,
                             ? g_value_get_boolean(value)
                             : TRUE;
         if (!show_desktop_menu) {
+            if (prewarm_id != 0) {
+                g_source_remove(prewarm_id);
+                prewarm_id = 0;
+            }
+            drop_prewarmed_menu();
             g_clear_object(&garcon_menu);
+        } else {
+            schedule_prewarm();
         }
     } else if(!strcmp(property, DESKTOP_MENU_SHOW_ICONS_PROP)) {
         show_desktop_menu_icons = G_VALUE_TYPE(value)
                                   ? g_value_get_boolean(value)
                                   : TRUE;
+        if (prewarmed_menu != NULL) {
+            g_object_set(prewarmed_menu, "show-menu-icons", show_desktop_menu_icons, NULL);
+        }
     }
 }
 #endif
@@ -147,6 +277,8 @@ menu_init(XfconfChannel *channel)
     }
 
     inited = TRUE;
+
+    schedule_prewarm();
 #endif
 }
 
@@ -159,6 +291,11 @@ menu_cleanup(XfconfChannel *channel)
                                              G_CALLBACK(menu_settings_changed),
                                              NULL);
 
+        if (prewarm_id != 0) {
+            g_source_remove(prewarm_id);
+            prewarm_id = 0;
+        }
+        drop_prewarmed_menu();
         g_clear_object(&garcon_menu);
 
         inited = FALSE;
@@ -72,6 +72,7 @@
 #include "xfdesktop-backdrop-manager.h"
 #include "xfdesktop-backdrop-media.h"
 #include "xfdesktop-common.h"
+#include "xfdesktop-startup-trace.h"
 #include "xfce-desktop.h"
 
 #ifdef ENABLE_X11
@@ -108,6 +109,7 @@ struct _XfceDesktop {
 
     XfwWorkspace *backdrop_workspace;
     GCancellable *backdrop_load_cancellable;
+    const gchar *backdrop_load_phase;  // interned; startup trace phase name
     cairo_surface_t *bg_surface;
     GdkRectangle bg_surface_region;
 
@@ -330,6 +332,10 @@ backdrop_loaded(XfdesktopBackdropMedia *bmedia, GdkRectangle *region, GFile *ima
 
     XfceDesktop *desktop = XFCE_DESKTOP(user_data);
 
+    if (desktop->backdrop_load_phase != NULL) {
+        xfdesktop_startup_trace_end(desktop->backdrop_load_phase);
+    }
+
     if (error != NULL) {
         if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
             DBG("backdrop loading cancelled");
@@ -396,6 +402,14 @@ fetch_backdrop(XfceDesktop *desktop, gboolean force_reload) {
         }
         desktop->backdrop_load_cancellable = g_cancellable_new();
 
+        if (xfdesktop_startup_trace_is_enabled()) {
+            // Each monitor loads its backdrop on its own, so give each one
+            // a phase of its own too.
+            gchar *phase = g_strdup_printf("backdrop-load:%s", xfw_monitor_get_connector(desktop->monitor));
+            desktop->backdrop_load_phase = g_intern_string(phase);
+            g_free(phase);
+            xfdesktop_startup_trace_begin(desktop->backdrop_load_phase);
+        }
         xfdesktop_backdrop_manager_get_image_surface(desktop->backdrop_manager,
                                                      desktop->backdrop_load_cancellable,
                                                      force_reload ? IMAGE_FORCE_RELOAD : IMAGE_GET_CACHED,
@@ -921,6 +935,8 @@ xfce_desktop_draw(GtkWidget *w,
     if (desktop->bmedia == NULL || !draw_backdrop_media(desktop, cr)) {
         cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 1.0);
         cairo_paint(cr);
+    } else {
+        xfdesktop_startup_trace_mark("first-backdrop-paint");
     }
 
     GList *children = gtk_container_get_children(GTK_CONTAINER(w));
@@ -1404,7 +1420,9 @@ xfce_desktop_monitor_changed(XfceDesktop *desktop, XfwMonitor *monitor) {
 
     if (gtk_widget_get_realized(GTK_WIDGET(desktop))) {
         xfce_desktop_place_on_monitor(desktop);
-        fetch_backdrop(desktop, TRUE);
+        // The backdrop manager has already been told about the monitor change
+        // and has dropped its cached surface if the size no longer fits.
+        fetch_backdrop(desktop, FALSE);
     }
 
     if (new_monitor) {
@@ -0,0 +1,179 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "xfdesktop-app-info-cache.h"
+
+struct _XfdesktopAppInfoCache {
+    GAppInfoMonitor *monitor;
+    GHashTable *entries;  // content type (owner) -> AppInfoEntry (owner)
+    guint n_lookups;  // number of times we had to ask GIO
+};
+
+typedef struct {
+    GList *app_infos;  // GAppInfo (owner)
+    const gchar *fingerprint;  // interned
+} AppInfoEntry;
+
+static void
+app_info_entry_free(AppInfoEntry *entry) {
+    g_list_free_full(entry->app_infos, g_object_unref);
+    g_free(entry);
+}
+
+static gint
+compare_strings(gconstpointer a, gconstpointer b) {
+    return g_strcmp0(*(const gchar **)a, *(const gchar **)b);
+}
+
+static const gchar *
+app_info_fingerprint_id(GAppInfo *app_info) {
+    const gchar *id = g_app_info_get_id(app_info);
+    if (id == NULL) {
+        id = g_app_info_get_executable(app_info);
+    }
+    return id != NULL ? id : "";
+}
+
+// Handlers are compared as a set: GIO doesn't promise any particular order,
+// and two types with the same handlers in a different order still get the
+// same "Open With" choices.  The default handler comes first, though, since
+// the menu offers it as the main "Open With" item.
+static const gchar *
+build_fingerprint(GList *app_infos, GAppInfo *default_app_info) {
+    GPtrArray *ids = g_ptr_array_new();
+    for (GList *l = app_infos; l != NULL; l = l->next) {
+        g_ptr_array_add(ids, (gpointer)app_info_fingerprint_id(G_APP_INFO(l->data)));
+    }
+    g_ptr_array_sort(ids, compare_strings);
+
+    GString *fingerprint = g_string_new(NULL);
+    if (default_app_info != NULL) {
+        g_string_append(fingerprint, app_info_fingerprint_id(default_app_info));
+    }
+    g_string_append_c(fingerprint, '\n');
+    for (guint i = 0; i < ids->len; ++i) {
+        g_string_append(fingerprint, g_ptr_array_index(ids, i));
+        g_string_append_c(fingerprint, '\n');
+    }
+    g_ptr_array_free(ids, TRUE);
+
+    const gchar *interned = g_intern_string(fingerprint->str);
+    g_string_free(fingerprint, TRUE);
+    return interned;
+}
+
+static AppInfoEntry *
+lookup_entry(XfdesktopAppInfoCache *cache, const gchar *content_type) {
+    AppInfoEntry *entry = g_hash_table_lookup(cache->entries, content_type);
+    if (entry == NULL) {
+        entry = g_new0(AppInfoEntry, 1);
+        entry->app_infos = g_app_info_get_all_for_type(content_type);
+        GAppInfo *default_app_info = g_app_info_get_default_for_type(content_type, FALSE);
+        entry->fingerprint = build_fingerprint(entry->app_infos, default_app_info);
+        if (default_app_info != NULL) {
+            g_object_unref(default_app_info);
+        }
+        g_hash_table_insert(cache->entries, g_strdup(content_type), entry);
+        cache->n_lookups++;
+    }
+    return entry;
+}
+
+static void
+app_infos_changed(XfdesktopAppInfoCache *cache) {
+    DBG("installed applications changed; dropping %u cached handler lists", g_hash_table_size(cache->entries));
+    g_hash_table_remove_all(cache->entries);
+}
+
+XfdesktopAppInfoCache *
+xfdesktop_app_info_cache_new(void) {
+    XfdesktopAppInfoCache *cache = g_new0(XfdesktopAppInfoCache, 1);
+    cache->entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)app_info_entry_free);
+    cache->monitor = g_app_info_monitor_get();
+    g_signal_connect_swapped(cache->monitor, "changed",
+                             G_CALLBACK(app_infos_changed), cache);
+    return cache;
+}
+
+GList *
+xfdesktop_app_info_cache_peek_all_for_type(XfdesktopAppInfoCache *cache, const gchar *content_type) {
+    g_return_val_if_fail(cache != NULL, NULL);
+    g_return_val_if_fail(content_type != NULL, NULL);
+    return lookup_entry(cache, content_type)->app_infos;
+}
+
+const gchar *
+xfdesktop_app_info_cache_peek_fingerprint(XfdesktopAppInfoCache *cache, const gchar *content_type) {
+    g_return_val_if_fail(cache != NULL, NULL);
+    g_return_val_if_fail(content_type != NULL, NULL);
+    return lookup_entry(cache, content_type)->fingerprint;
+}
+
+/**
+ * xfdesktop_app_info_cache_share_handlers:
+ * @cache: an #XfdesktopAppInfoCache.
+ * @content_types: an array of content types, possibly with duplicates.
+ * @n_content_types: the length of @content_types.
+ *
+ * Checks whether all of @content_types can be opened by the same set of
+ * applications.  Each distinct content type is only looked up once, and
+ * consecutive runs of the same type are skipped without a lookup at all.
+ *
+ * Return value: %TRUE if all content types share the same handlers.
+ **/
+gboolean
+xfdesktop_app_info_cache_share_handlers(XfdesktopAppInfoCache *cache,
+                                        const gchar *const *content_types,
+                                        gsize n_content_types)
+{
+    g_return_val_if_fail(cache != NULL, FALSE);
+    g_return_val_if_fail(content_types != NULL || n_content_types == 0, FALSE);
+
+    if (n_content_types == 0) {
+        return TRUE;
+    }
+
+    const gchar *last_content_type = content_types[0];
+    const gchar *fingerprint = xfdesktop_app_info_cache_peek_fingerprint(cache, last_content_type);
+
+    for (gsize i = 1; i < n_content_types; ++i) {
+        if (g_strcmp0(content_types[i], last_content_type) != 0) {
+            // Fingerprints are interned, so a pointer compare is enough.
+            if (xfdesktop_app_info_cache_peek_fingerprint(cache, content_types[i]) != fingerprint) {
+                return FALSE;
+            }
+            last_content_type = content_types[i];
+        }
+    }
+
+    return TRUE;
+}
+
+void
+xfdesktop_app_info_cache_free(XfdesktopAppInfoCache *cache) {
+    if (cache != NULL) {
+        g_signal_handlers_disconnect_by_data(cache->monitor, cache);
+        g_object_unref(cache->monitor);
+        g_hash_table_destroy(cache->entries);
+        g_free(cache);
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __XFDESKTOP_APP_INFO_CACHE_H__
+#define __XFDESKTOP_APP_INFO_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfdesktopAppInfoCache XfdesktopAppInfoCache;
+
+XfdesktopAppInfoCache *xfdesktop_app_info_cache_new(void);
+
+// Both return values are owned by the cache, and are only valid until the
+// installed applications change.
+GList *xfdesktop_app_info_cache_peek_all_for_type(XfdesktopAppInfoCache *cache,
+                                                  const gchar *content_type);
+const gchar *xfdesktop_app_info_cache_peek_fingerprint(XfdesktopAppInfoCache *cache,
+                                                       const gchar *content_type);
+
+gboolean xfdesktop_app_info_cache_share_handlers(XfdesktopAppInfoCache *cache,
+                                                 const gchar *const *content_types,
+                                                 gsize n_content_types);
+
+void xfdesktop_app_info_cache_free(XfdesktopAppInfoCache *cache);
+
+G_END_DECLS
+
+#endif /* __XFDESKTOP_APP_INFO_CACHE_H__ */
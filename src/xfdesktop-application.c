@@ -55,6 +55,7 @@
 #include "xfce-desktop.h"
 #include "xfdesktop-common.h"
 #include "xfdesktop-backdrop-manager.h"
+#include "xfdesktop-startup-trace.h"
 
 #ifdef ENABLE_DESKTOP_ICONS
 #include "xfdesktop-icon-view-manager.h"
@@ -95,6 +96,8 @@
 #define OPTION_DISABLE_DEBUG "disable-debug"
 #define OPTION_QUIT ACTION_QUIT
 #define OPTION_DISABLE_WM_CHECK "disable-wm-check"
+#define OPTION_STARTUP_TRACE "startup-trace"
+#define OPTION_STARTUP_TRACE_FILE "startup-trace-file"
 
 typedef GtkMenu *(*PopulateMenuFunc)(GtkMenu *, gint);
 
@@ -287,6 +290,8 @@ xfdesktop_application_init(XfdesktopApplication *app)
         { OPTION_DISABLE_WM_CHECK, 'D', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE, &app->disable_wm_check, N_("Do not wait for a window manager on startup"), NULL },
 #endif
         { ACTION_QUIT, 'Q', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE, NULL, N_("Cause xfdesktop to quit"), NULL },
+        { OPTION_STARTUP_TRACE, '\0', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE, NULL, N_("Print how long each phase of startup took"), NULL },
+        { OPTION_STARTUP_TRACE_FILE, '\0', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_FILENAME, NULL, N_("Also write the startup phases to FILE as a Chrome trace"), N_("FILE") },
         G_OPTION_ENTRY_NULL
     };
     const struct {
@@ -686,6 +691,7 @@ wait_for_wm_complete(WaitForWMStatus status, gpointer data) {
             // Intentionally fall through
 
         case WAIT_FOR_WM_SUCCESSFUL:
+            xfdesktop_startup_trace_end("wait-for-wm");
             g_clear_object(&app->cancel_wait_for_wm);
             xfdesktop_application_start(app);
             g_application_release(G_APPLICATION(app));
@@ -717,6 +723,8 @@ xfdesktop_application_startup(GApplication *g_application)
 
     TRACE("entering");
 
+    xfdesktop_startup_trace_begin("application-startup");
+
     if (app->args->has_remote_only_command) {
         g_printerr(PACKAGE " is not running\n");
         exit(1);
@@ -740,6 +748,7 @@ xfdesktop_application_startup(GApplication *g_application)
     if(!app->disable_wm_check && xfw_windowing_get() == XFW_WINDOWING_X11) {
         g_application_hold(g_application);
         app->cancel_wait_for_wm = g_cancellable_new();
+        xfdesktop_startup_trace_begin("wait-for-wm");
         xfdesktop_x11_wait_for_wm(wait_for_wm_complete,
                                   g_application,
                                   app->cancel_wait_for_wm);
@@ -749,6 +758,8 @@ xfdesktop_application_startup(GApplication *g_application)
         /* directly launch */
         xfdesktop_application_start(app);
     }
+
+    xfdesktop_startup_trace_end("application-startup");
 }
 
 static void
@@ -1058,6 +1069,8 @@ xfdesktop_application_start(XfdesktopApplication *app)
 
     TRACE("entering");
 
+    xfdesktop_startup_trace_begin("application-start");
+
     if (xfw_windowing_get() == XFW_WINDOWING_WAYLAND) {
 #ifdef ENABLE_WAYLAND
         if (!gtk_layer_is_supported()) {
@@ -1106,16 +1119,22 @@ xfdesktop_application_start(XfdesktopApplication *app)
         xfdesktop_migrate_backdrop_settings(gdk_display_get_default(), app->channel);
     }
 
+    xfdesktop_startup_trace_begin("backdrop-manager");
     app->backdrop_manager = xfdesktop_backdrop_manager_new(app->screen, app->channel);
+    xfdesktop_startup_trace_end("backdrop-manager");
 
+    xfdesktop_startup_trace_begin("menu-init");
     menu_init(app->channel);
     windowlist_init(app->channel);
+    xfdesktop_startup_trace_end("menu-init");
 
+    xfdesktop_startup_trace_begin("create-desktops");
     GList *monitors = xfw_screen_get_monitors(app->screen);
     for (GList *l = monitors; l != NULL; l = l->next) {
         XfwMonitor *monitor = XFW_MONITOR(l->data);
         screen_monitor_added(app->screen, monitor, app);
     }
+    xfdesktop_startup_trace_end("create-desktops");
 
     g_signal_connect(app->screen, "monitor-added",
                      G_CALLBACK(screen_monitor_added), app);
@@ -1126,6 +1145,8 @@ xfdesktop_application_start(XfdesktopApplication *app)
         xfce_desktop_set_is_active(XFCE_DESKTOP(g_list_nth_data(app->desktops, 0)), TRUE);
     }
 
+    // Binding the icon style is what creates the icon view manager.
+    xfdesktop_startup_trace_begin("icon-style-bind");
     xfconf_g_property_bind(app->channel, DESKTOP_ICONS_STYLE_PROP, XFCE_TYPE_DESKTOP_ICON_STYLE, app, "icon-style");
     if ((gint)app->icon_style == -1) {
         XfceDesktopIconStyle icon_style = xfconf_channel_get_int(app->channel,
@@ -1133,6 +1154,7 @@ xfdesktop_application_start(XfdesktopApplication *app)
                                                                  ICON_STYLE_DEFAULT);
         xfdesktop_application_set_icon_style(app, icon_style);
     }
+    xfdesktop_startup_trace_end("icon-style-bind");
 
     // Put a hold on the app, because at times we may have no monitors
     // (suspend/resume, etc.), which will cause us to destroy all our
@@ -1154,6 +1176,8 @@ xfdesktop_application_start(XfdesktopApplication *app)
         g_warning("Unable to set up POSIX signal handlers: %s", error->message);
         g_clear_error(&error);
     }
+
+    xfdesktop_startup_trace_end("application-start");
 }
 
 static void
@@ -1163,6 +1187,9 @@ xfdesktop_application_shutdown(GApplication *g_application)
 
     TRACE("entering");
 
+    // In case we're quitting before startup settled down.
+    xfdesktop_startup_trace_finish();
+
     if (app->active_root_menu != NULL) {
         gtk_menu_shell_deactivate(GTK_MENU_SHELL(app->active_root_menu));
         app->active_root_menu = NULL;
@@ -1280,6 +1307,13 @@ xfdesktop_application_handle_local_options(GApplication *g_application, GVariant
         check_bool_option(options, OPTION_ARRANGE, FALSE))
     {
         app->args->has_remote_only_command = TRUE;
+    } else {
+        gchar *trace_file = NULL;
+        g_variant_dict_lookup(options, OPTION_STARTUP_TRACE_FILE, "^ay", &trace_file);
+        if (check_bool_option(options, OPTION_STARTUP_TRACE, FALSE) || trace_file != NULL) {
+            xfdesktop_startup_trace_enable(trace_file);
+        }
+        g_free(trace_file);
     }
 
     return G_APPLICATION_CLASS(xfdesktop_application_parent_class)->handle_local_options(g_application, options);
@@ -77,6 +77,9 @@ typedef struct {
     GFileMonitor *image_file_monitor;
     XfdesktopBackdropCycler *cycler;
     gboolean is_spanning;
+    // Geometry the surface was rendered for: the union of all monitors when
+    // spanning, or the monitor's own geometry otherwise.
+    GdkRectangle geometry;
 } Backdrop;
 
 typedef struct {
@@ -93,6 +96,7 @@ typedef struct {
     GCancellable *main_cancellable;
     gchar *property_prefix;
     gboolean is_spanning;
+    GdkRectangle geometry;
     GFile *image_file;
 
     GList *instances; // RenderInstanceData
@@ -101,6 +105,8 @@ typedef struct {
 typedef struct {
     XfdesktopBackdropManager *manager;
     gchar *property_prefix_prefix;
+    GdkRectangle monitor_geometry;
+    GdkRectangle span_geometry;
 } BackdropInvalidateForeachData;
 
 static GQuark monitor_quark(void);
@@ -120,6 +126,9 @@ static void xfdesktop_backdrop_manager_finalize(GObject *obj);
 static void channel_property_changed(XfdesktopBackdropManager *manager,
                                      const gchar *property_name,
                                      const GValue *value);
+static void screen_monitor_added(XfwScreen *screen,
+                                 XfwMonitor *monitor,
+                                 XfdesktopBackdropManager *manager);
 static void screen_monitor_removed(XfwScreen *screen,
                                    XfwMonitor *monitor,
                                    XfdesktopBackdropManager *manager);
@@ -294,6 +303,8 @@ xfdesktop_backdrop_manager_constructed(GObject *obj) {
     XfdesktopBackdropManager *manager = XFDESKTOP_BACKDROP_MANAGER(obj);
     manager->workspace_manager = xfw_screen_get_workspace_manager(manager->xfw_screen);
 
+    g_signal_connect(manager->xfw_screen, "monitor-added",
+                     G_CALLBACK(screen_monitor_added), manager);
     g_signal_connect(manager->xfw_screen, "monitor-removed",
                      G_CALLBACK(screen_monitor_removed), manager);
 
@@ -590,6 +601,52 @@ compute_spanning_geometry(XfdesktopBackdropManager *manager, GdkRectangle *geome
     }
 }
 
+static gboolean
+backdrop_geometry_size_matches(Backdrop *backdrop, const GdkRectangle *geometry) {
+    return backdrop->geometry.width == geometry->width && backdrop->geometry.height == geometry->height;
+}
+
+static void
+refresh_backdrop_for_geometry(XfdesktopBackdropManager *manager,
+                              const gchar *property_prefix,
+                              Backdrop *backdrop,
+                              const GdkRectangle *geometry)
+{
+    if (backdrop->bmedia != NULL && backdrop_geometry_size_matches(backdrop, geometry)) {
+        // Only the position changed; the already-rendered surface is still
+        // valid, and the desktops just need to pick up their new regions.
+        DBG("geometry for %s moved without resizing; reusing surface", property_prefix);
+    } else {
+        g_clear_object(&backdrop->bmedia);
+    }
+    backdrop->geometry = *geometry;
+    emit_backdrop_changed(manager, property_prefix, backdrop);
+}
+
+static void
+backdrops_ht_refresh_spanning(gpointer key, gpointer value, gpointer data) {
+    BackdropInvalidateForeachData *bifd = data;
+    Backdrop *backdrop = value;
+
+    if (backdrop->is_spanning) {
+        refresh_backdrop_for_geometry(bifd->manager, key, backdrop, &bifd->span_geometry);
+    }
+}
+
+static void
+update_spanning_backdrops(XfdesktopBackdropManager *manager) {
+    BackdropInvalidateForeachData bifd = {
+        .manager = manager,
+    };
+    compute_spanning_geometry(manager, &bifd.span_geometry);
+    g_hash_table_foreach(manager->backdrops, backdrops_ht_refresh_spanning, &bifd);
+}
+
+static void
+screen_monitor_added(XfwScreen *screen, XfwMonitor *xfwmonitor, XfdesktopBackdropManager *manager) {
+    update_spanning_backdrops(manager);
+}
+
 static void
 screen_monitor_removed(XfwScreen *screen, XfwMonitor *xfwmonitor, XfdesktopBackdropManager *manager) {
     for (guint i = 0; i < manager->monitors->len; ++i) {
@@ -603,12 +660,14 @@ screen_monitor_removed(XfwScreen *screen, XfwMonitor *xfwmonitor, XfdesktopBackd
             break;
         }
     }
+
+    update_spanning_backdrops(manager);
 }
 
 static void
 notify_complete(XfdesktopBackdropMedia *bmedia,
                 Monitor *monitor,
-                gboolean is_spanning,
+                const GdkRectangle *span_geometry,
                 GFile *image_file,
                 GetImageSurfaceCallback callback,
                 gpointer callback_user_data)
@@ -619,7 +678,12 @@ notify_complete(XfdesktopBackdropMedia *bmedia,
 
     GdkRectangle region;
     xfw_monitor_get_physical_geometry(monitor->xfwmonitor, &region);
-    if (!is_spanning) {
+    if (span_geometry != NULL) {
+        // Every monitor shares the same surface; each one just gets the part
+        // of it that it covers, relative to the origin of the union.
+        region.x -= span_geometry->x;
+        region.y -= span_geometry->y;
+    } else {
         region.x = region.y = 0;
     }
 
@@ -709,6 +773,7 @@ render_finished(XfdesktopBackdropMedia *bmedia, gint width, gint height, GError
                 backdrop->image_file = g_object_ref(rdata->image_file);
             }
             backdrop->is_spanning = rdata->is_spanning;
+            backdrop->geometry = rdata->geometry;
 
             if (backdrop->image_file_monitor != NULL) {
                 g_file_monitor_cancel(backdrop->image_file_monitor);
@@ -730,7 +795,7 @@ render_finished(XfdesktopBackdropMedia *bmedia, gint width, gint height, GError
             RenderInstanceData *ridata = l->data;
             notify_complete(bmedia,
                             ridata->monitor,
-                            rdata->is_spanning,
+                            rdata->is_spanning ? &rdata->geometry : NULL,
                             error == NULL ? rdata->image_file : NULL,
                             ridata->callback,
                             ridata->callback_user_data);
@@ -818,6 +883,7 @@ create_backdrop(XfdesktopBackdropManager *manager,
     rdata->main_cancellable = g_cancellable_new();
     rdata->property_prefix = property_prefix;
     rdata->is_spanning = is_spanning;
+    rdata->geometry = geom;
     rdata->image_file = image_file;
 
     RenderInstanceData *ridata = g_new0(RenderInstanceData, 1);
@@ -886,11 +952,22 @@ xfdesktop_backdrop_manager_get_image_surface(XfdesktopBackdropManager *manager,
     }
 
     Backdrop *backdrop = g_hash_table_lookup(manager->backdrops, property_prefix);
+    if (backdrop != NULL && backdrop->bmedia != NULL && is_spanning) {
+        GdkRectangle span_geometry;
+        compute_spanning_geometry(manager, &span_geometry);
+        if (backdrop_geometry_size_matches(backdrop, &span_geometry)) {
+            backdrop->geometry = span_geometry;
+        } else {
+            DBG("spanning geometry size changed; re-rendering");
+            g_clear_object(&backdrop->bmedia);
+        }
+    }
+
     if (backdrop != NULL && backdrop->bmedia != NULL) {
         g_free(property_prefix);
         notify_complete(backdrop->bmedia,
                         monitor,
-                        is_spanning,
+                        backdrop->is_spanning ? &backdrop->geometry : NULL,
                         backdrop->image_file,
                         callback,
                         callback_user_data);
@@ -960,11 +1037,12 @@ static void
 backdrops_ht_invalidate(gpointer key, gpointer value, gpointer data) {
     const gchar *property_prefix = key;
     BackdropInvalidateForeachData *bifd = data;
+    Backdrop *backdrop = value;
 
-    if (g_str_has_prefix(property_prefix, bifd->property_prefix_prefix)) {
-        Backdrop *backdrop = value;
-        g_clear_object(&backdrop->bmedia);
-        emit_backdrop_changed(bifd->manager, property_prefix, backdrop);
+    if (backdrop->is_spanning) {
+        refresh_backdrop_for_geometry(bifd->manager, property_prefix, backdrop, &bifd->span_geometry);
+    } else if (g_str_has_prefix(property_prefix, bifd->property_prefix_prefix)) {
+        refresh_backdrop_for_geometry(bifd->manager, property_prefix, backdrop, &bifd->monitor_geometry);
     }
 }
 
@@ -978,6 +1056,8 @@ xfdesktop_backdrop_manager_monitor_changed(XfdesktopBackdropManager *manager, Xf
         .manager = manager,
         .property_prefix_prefix = build_property_prefix_prefix(manager, monitor),
     };
+    xfw_monitor_get_physical_geometry(xfwmonitor, &bifd.monitor_geometry);
+    compute_spanning_geometry(manager, &bifd.span_geometry);
     g_hash_table_foreach(manager->backdrops, backdrops_ht_invalidate, &bifd);
     g_free(bifd.property_prefix_prefix);
 }
@@ -35,6 +35,7 @@
 #include "xfdesktop-file-icon.h"
 #include "xfdesktop-file-icon-manager.h"
 #include "xfdesktop-file-utils.h"
+#include "xfdesktop-marshal.h"
 
 #ifndef I_
 #define I_(str)  g_intern_static_string(str)
@@ -50,6 +51,7 @@ enum
 enum
 {
   CHANGED,
+  CUT_FILES_CHANGED,
   LAST_SIGNAL,
 };
 
@@ -94,6 +96,8 @@ static void xfdesktop_clipboard_manager_clear_callback    (GtkClipboard
 static void xfdesktop_clipboard_manager_transfer_files    (XfdesktopClipboardManager      *manager,
                                                            gboolean                        copy,
                                                            GList                          *files);
+static void xfdesktop_clipboard_manager_set_cut_files     (XfdesktopClipboardManager      *manager,
+                                                           GList                          *files);
 
 
 
@@ -101,7 +105,10 @@ struct _XfdesktopClipboardManagerClass
 {
   GObjectClass __parent__;
 
-  void (*changed) (XfdesktopClipboardManager *manager);
+  void (*changed)           (XfdesktopClipboardManager *manager);
+  void (*cut_files_changed) (XfdesktopClipboardManager *manager,
+                             GList                     *added,
+                             GList                     *removed);
 };
 
 struct _XfdesktopClipboardManager
@@ -114,6 +121,7 @@ struct _XfdesktopClipboardManager
 
   gboolean      files_cutted;
   GList        *files;
+  GHashTable   *cut_files;  /* GFile (owner) set, empty unless files_cutted */
 };
 
 typedef struct
@@ -209,6 +217,27 @@ xfdesktop_clipboard_manager_class_init (gpointer g_class,
                   NULL, NULL,
                   g_cclosure_marshal_VOID__VOID,
                   G_TYPE_NONE, 0);
+
+  /**
+   * XfdesktopClipboardManager::cut-files-changed:
+   * @manager : a #XfdesktopClipboardManager.
+   * @added   : a #GList of #GFile<!---->s that were just cut.
+   * @removed : a #GList of #GFile<!---->s that are no longer cut.
+   *
+   * This signal is emitted whenever the set of files that were
+   * cut to the clipboard associated with @manager changes, and
+   * only carries the difference to the previous set.
+   **/
+  manager_signals[CUT_FILES_CHANGED] =
+    g_signal_new (I_("cut-files-changed"),
+                  G_TYPE_FROM_CLASS (g_class),
+                  G_SIGNAL_RUN_FIRST,
+                  G_STRUCT_OFFSET (XfdesktopClipboardManagerClass, cut_files_changed),
+                  NULL, NULL,
+                  xfdesktop_marshal_VOID__POINTER_POINTER,
+                  G_TYPE_NONE, 2,
+                  G_TYPE_POINTER,
+                  G_TYPE_POINTER);
 }
 
 
@@ -220,6 +249,7 @@ xfdesktop_clipboard_manager_init (GTypeInstance *instance,
   XfdesktopClipboardManager *manager = XFDESKTOP_CLIPBOARD_MANAGER (instance);
 
   manager->x_special_gnome_copied_files = gdk_atom_intern ("x-special/gnome-copied-files", FALSE);
+  manager->cut_files = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, NULL);
 }
 
 
@@ -239,6 +269,7 @@ xfdesktop_clipboard_manager_finalize (GObject *object)
       g_object_unref (G_OBJECT (lp->data));
     }
   g_list_free (manager->files);
+  g_hash_table_destroy (manager->cut_files);
 
   /* disconnect from the clipboard */
   g_signal_handlers_disconnect_by_func (G_OBJECT (manager->clipboard),
@@ -286,6 +317,17 @@ xfdesktop_clipboard_manager_file_destroyed (XfdesktopClipboardManager *manager,
   /* remove the file from our list */
   manager->files = g_list_remove (manager->files, file);
 
+  /* and from the cut set, telling listeners about it */
+  GFile *gfile = xfdesktop_file_icon_peek_file (file);
+  if (gfile != NULL && g_hash_table_contains (manager->cut_files, gfile))
+    {
+      GList removed = { gfile, NULL, NULL };
+      g_object_ref (gfile);
+      g_hash_table_remove (manager->cut_files, gfile);
+      g_signal_emit (G_OBJECT (manager), manager_signals[CUT_FILES_CHANGED], 0, NULL, &removed);
+      g_object_unref (gfile);
+    }
+
   /* disconnect from the file */
   g_object_weak_unref(G_OBJECT (file),
                       (GWeakNotify)xfdesktop_clipboard_manager_file_destroyed,
@@ -532,6 +574,9 @@ xfdesktop_clipboard_manager_clear_callback (GtkClipboard *clipboard,
     }
   g_list_free (manager->files);
   manager->files = NULL;
+
+  /* someone else owns the clipboard now, so nothing is cut anymore */
+  xfdesktop_clipboard_manager_set_cut_files (manager, NULL);
 }
 
 
@@ -567,6 +612,9 @@ xfdesktop_clipboard_manager_transfer_files (XfdesktopClipboardManager *manager,
                         manager);
     }
 
+  /* update the cut set, which also un-cuts everything on a copy */
+  xfdesktop_clipboard_manager_set_cut_files (manager, copy ? NULL : manager->files);
+
   /* acquire the CLIPBOARD ownership */
   gtk_clipboard_set_with_owner (manager->clipboard, clipboard_targets,
                                 G_N_ELEMENTS (clipboard_targets),
@@ -583,6 +631,49 @@ xfdesktop_clipboard_manager_transfer_files (XfdesktopClipboardManager *manager,
 
 
 
+static void
+xfdesktop_clipboard_manager_set_cut_files (XfdesktopClipboardManager *manager,
+                                           GList                     *files)
+{
+  GHashTable *cut_files;
+  GHashTableIter iter;
+  GFile *gfile;
+  GList *added = NULL;
+  GList *removed = NULL;
+  GList *lp;
+
+  cut_files = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, NULL);
+  for (lp = files; lp != NULL; lp = lp->next)
+    {
+      gfile = xfdesktop_file_icon_peek_file (XFDESKTOP_FILE_ICON (lp->data));
+      if (gfile != NULL && g_hash_table_add (cut_files, g_object_ref (gfile))
+          && !g_hash_table_contains (manager->cut_files, gfile))
+        {
+          added = g_list_prepend (added, gfile);
+        }
+    }
+
+  g_hash_table_iter_init (&iter, manager->cut_files);
+  while (g_hash_table_iter_next (&iter, (gpointer) &gfile, NULL))
+    {
+      if (!g_hash_table_contains (cut_files, gfile))
+        removed = g_list_prepend (removed, gfile);
+    }
+
+  /* the old set keeps the removed files alive until we've emitted */
+  GHashTable *old_cut_files = manager->cut_files;
+  manager->cut_files = cut_files;
+
+  if (added != NULL || removed != NULL)
+    g_signal_emit (G_OBJECT (manager), manager_signals[CUT_FILES_CHANGED], 0, added, removed);
+
+  g_list_free (added);
+  g_list_free (removed);
+  g_hash_table_destroy (old_cut_files);
+}
+
+
+
 /**
  * xfdesktop_clipboard_manager_get_for_display:
  * @display : a #GdkDisplay.
@@ -648,7 +739,8 @@ xfdesktop_clipboard_manager_has_cutted_file (XfdesktopClipboardManager *manager,
   g_return_val_if_fail (XFDESKTOP_IS_CLIPBOARD_MANAGER (manager), FALSE);
   g_return_val_if_fail (XFDESKTOP_IS_FILE_ICON((gpointer)file), FALSE);
 
-  return (manager->files_cutted && g_list_find (manager->files, file) != NULL);
+  GFile *gfile = xfdesktop_file_icon_peek_file ((XfdesktopFileIcon *) file);
+  return gfile != NULL && g_hash_table_contains (manager->cut_files, gfile);
 }
 
 
@@ -57,6 +57,7 @@
 
 #include "common/xfdesktop-keyboard-shortcuts.h"
 #include "xfce-desktop.h"
+#include "xfdesktop-app-info-cache.h"
 #include "xfdesktop-backdrop-manager.h"
 #include "xfdesktop-clipboard-manager.h"
 #include "xfdesktop-common.h"
@@ -74,6 +75,8 @@
 #include "xfdesktop-icon.h"
 #include "xfdesktop-regular-file-icon.h"
 #include "xfdesktop-special-file-icon.h"
+#include "xfdesktop-startup-trace.h"
+#include "xfdesktop-template-index.h"
 #include "xfdesktop-volume-icon.h"
 
 #include <libxfce4util/libxfce4util.h>
@@ -124,6 +127,9 @@ struct _XfdesktopFileIconManager
 
     GList *pending_created_desktop_files;
 
+    XfdesktopTemplateIndex *template_index;
+    XfdesktopAppInfoCache *app_info_cache;
+
 #ifdef HAVE_THUNARX
     GList *thunarx_menu_providers;
     GList *thunarx_properties_providers;
@@ -299,12 +305,18 @@ static void xfdesktop_file_icon_manager_icon_moved(XfdesktopIconView *icon_view,
                                                    gint dest_row,
                                                    gint dest_col,
                                                    MonitorData *mdata);
+static void xfdesktop_file_icon_manager_icons_moved(XfdesktopIconView *icon_view,
+                                                    XfdesktopIconView *source_icon_view,
+                                                    GArray *moves,
+                                                    MonitorData *mdata);
 static void xfdesktop_file_icon_manager_activate_selected(MonitorData *mdata);
 
 static GList *xfdesktop_file_icon_manager_get_selected_icons(XfdesktopFileIconManager *fmanager,
                                                              XfdesktopIconView *icon_view);
 
 static void xfdesktop_file_icon_manager_clipboard_changed(XfdesktopClipboardManager *cmanager,
+                                                          GList *added,
+                                                          GList *removed,
                                                           XfdesktopFileIconManager *fmanager);
 
 static void xfdesktop_file_icon_manager_start_grid_resize(XfdesktopIconView *icon_view,
@@ -462,10 +474,25 @@ xfdesktop_file_icon_manager_constructed(GObject *obj)
     } else
         g_object_ref(G_OBJECT(clipboard_manager));
 
-    g_signal_connect(G_OBJECT(clipboard_manager), "changed",
+    g_signal_connect(G_OBJECT(clipboard_manager), "cut-files-changed",
                      G_CALLBACK(xfdesktop_file_icon_manager_clipboard_changed),
                      fmanager);
 
+    fmanager->app_info_cache = xfdesktop_app_info_cache_new();
+
+    /* check if XDG_TEMPLATES_DIR="$HOME" and don't show templates if so. */
+    const gchar *templates_dir_path = g_get_user_special_dir(G_USER_DIRECTORY_TEMPLATES);
+    DBG("templates dir path: %s", templates_dir_path);
+    if (templates_dir_path != NULL) {
+        GFile *home_dir = g_file_new_for_path(xfce_get_homedir());
+        GFile *templates_dir = g_file_new_for_path(templates_dir_path);
+        if (!g_file_equal(home_dir, templates_dir)) {
+            fmanager->template_index = xfdesktop_template_index_new(templates_dir);
+        }
+        g_object_unref(templates_dir);
+        g_object_unref(home_dir);
+    }
+
     if(!xfdesktop_file_utils_dbus_init())
         g_warning("Unable to initialise D-Bus.  Some xfdesktop features may be unavailable.");
 
@@ -502,7 +529,10 @@ G_GNUC_END_IGNORE_DEPRECATIONS
     fmanager->position_configs = xfdesktop_icon_position_configs_new(positions_file);
 
     GError *error = NULL;
-    if (!xfdesktop_icon_position_configs_load(fmanager->position_configs, &error)) {
+    xfdesktop_startup_trace_begin("icon-positions-load");
+    gboolean positions_loaded = xfdesktop_icon_position_configs_load(fmanager->position_configs, &error);
+    xfdesktop_startup_trace_end("icon-positions-load");
+    if (!positions_loaded) {
         if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
             g_message("Unable to load icon positions: %s", error->message);
             if (g_file_test(g_file_peek_path(positions_file), G_FILE_TEST_EXISTS)) {
@@ -650,6 +680,9 @@ xfdesktop_file_icon_manager_finalize(GObject *obj)
                                          fmanager);
     g_object_unref(G_OBJECT(clipboard_manager));
 
+    xfdesktop_template_index_free(fmanager->template_index);
+    xfdesktop_app_info_cache_free(fmanager->app_info_cache);
+
     g_object_unref(G_OBJECT(fmanager->desktop_icon));
 
 #ifdef HAVE_THUNARX
@@ -1170,103 +1203,35 @@ xfdesktop_file_icon_template_item_activated(GtkWidget *mi, MonitorData *mdata) {
     create_from_template(mdata, file, dest_row, dest_col);
 }
 
-static gint
-compare_template_files(gconstpointer a, gconstpointer b) {
-    GFileInfo *info_a = g_object_get_data(G_OBJECT(a), "info");
-    GFileInfo *info_b = g_object_get_data(G_OBJECT(b), "info");
-    GFileType type_a = g_file_info_get_file_type(info_a);
-    GFileType type_b = g_file_info_get_file_type(info_b);
-    const gchar* name_a = g_file_info_get_display_name(info_a);
-    const gchar* name_b = g_file_info_get_display_name(info_b);
-
-    if(!info_a || !info_b)
-        return 0;
-
-    if(type_a == type_b) {
-        return g_strcmp0(name_a, name_b);
-    } else {
-        if(type_a == G_FILE_TYPE_DIRECTORY)
-            return -1;
-        else
-            return 1;
-    }
-}
-
 static void
 xfdesktop_file_icon_menu_fill_template_menu(GtkWidget *menu,
-                                            GFile *template_dir,
+                                            const XfdesktopTemplateNode *template_dir,
                                             MonitorData *mdata,
                                             gint dest_row,
-                                            gint dest_col,
-                                            gboolean recursive)
+                                            gint dest_col)
 {
-    g_return_if_fail(G_IS_FILE(template_dir));
-
-    GFileEnumerator *enumerator = g_file_enumerate_children(template_dir,
-                                                            XFDESKTOP_FILE_INFO_NAMESPACE,
-                                                            G_FILE_QUERY_INFO_NONE,
-                                                            NULL, NULL);
-
-    if(enumerator == NULL)
-        return;
-
-    GList *files = NULL;
-    GFileInfo *info;
-    while((info = g_file_enumerator_next_file(enumerator, NULL, NULL)) != NULL) {
-        /* skip hidden & backup files */
-        if(g_file_info_get_is_hidden(info) || g_file_info_get_is_backup(info)) {
-            g_object_unref(info);
-            continue;
-        }
-
-        GFile *file = g_file_get_child(template_dir, g_file_info_get_name(info));
-        g_object_set_data_full(G_OBJECT(file), "info", info, g_object_unref);
-        files = g_list_prepend(files, file);
-    }
-
-    g_object_unref(enumerator);
-
-    files = g_list_sort(files, compare_template_files);
-
-    for (GList *lp = files; lp != NULL; lp = lp->next) {
-        GFile *file = G_FILE(lp->data);
-        info = G_FILE_INFO(g_object_get_data(G_OBJECT(file), "info"));
-
-        /* create and fill template submenu */
-        GtkWidget *submenu = NULL;
-        if(g_file_info_get_file_type(info) == G_FILE_TYPE_DIRECTORY) {
-            submenu = gtk_menu_new();
-
-            xfdesktop_file_icon_menu_fill_template_menu(submenu, file, mdata, dest_row, dest_col, TRUE);
-
-            if(!gtk_container_get_children((GtkContainer*) submenu)) {
-                g_object_unref(file);
-                continue;
-            }
-        }
-
-        /* generate a label by stripping off the extension */
-        gchar *label = g_strdup(g_file_info_get_display_name(info));
-        gchar *dot = g_utf8_strrchr(label, -1, '.');
-        if(dot)
-            *dot = '\0';
+    // Everything here comes from the template index, so there's no I/O
+    // while the menu is popping up.
+    for (guint i = 0; i < template_dir->children->len; ++i) {
+        const XfdesktopTemplateNode *node = g_ptr_array_index(template_dir->children, i);
 
         /* determine the icon to display */
-        GIcon *icon = g_file_info_get_icon(info);
-        GtkWidget *image = gtk_image_new_from_gicon(icon, GTK_ICON_SIZE_MENU);
+        GtkWidget *image = node->icon != NULL ? gtk_image_new_from_gicon(node->icon, GTK_ICON_SIZE_MENU) : NULL;
 
         /* allocate a new menu item */
-        GtkWidget *item = xfdesktop_menu_create_menu_item_with_markup(label, image);
-        g_free(label);
+        GtkWidget *item = xfdesktop_menu_create_menu_item_with_markup(node->label, image);
 
         /* add the item to the menu */
         gtk_widget_show(item);
         gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
 
-        if (submenu != NULL) {
+        if (node->children != NULL) {
+            /* create and fill template submenu */
+            GtkWidget *submenu = gtk_menu_new();
+            xfdesktop_file_icon_menu_fill_template_menu(submenu, node, mdata, dest_row, dest_col);
             gtk_menu_item_set_submenu(GTK_MENU_ITEM(item), submenu);
         } else {
-            g_object_set_data_full(G_OBJECT(item), FILE_KEY, g_object_ref(file), g_object_unref);
+            g_object_set_data_full(G_OBJECT(item), FILE_KEY, g_object_ref(node->file), g_object_unref);
             g_object_set_data(G_OBJECT(item), DEST_ROW_KEY, GINT_TO_POINTER(dest_row));
             g_object_set_data(G_OBJECT(item), DEST_COL_KEY, GINT_TO_POINTER(dest_col));
 
@@ -1274,13 +1239,7 @@ xfdesktop_file_icon_menu_fill_template_menu(GtkWidget *menu,
                              G_CALLBACK(xfdesktop_file_icon_template_item_activated),
                              mdata);
         }
-
-        g_object_unref(file);
     }
-
-    g_list_free(files);
-
-    return;
 }
 
 #ifdef HAVE_THUNARX
@@ -1425,6 +1384,8 @@ finish_create_icon_view(XfdesktopFileIconManager *fmanager, XfceDesktop *desktop
 
     g_signal_connect(icon_view, "icon-moved",
                      G_CALLBACK(xfdesktop_file_icon_manager_icon_moved), mdata);
+    g_signal_connect(icon_view, "icons-moved",
+                     G_CALLBACK(xfdesktop_file_icon_manager_icons_moved), mdata);
     g_signal_connect_swapped(icon_view, "icon-activated",
                              G_CALLBACK(xfdesktop_file_icon_manager_activate_selected), mdata);
 
@@ -1759,7 +1720,8 @@ xfdesktop_file_icon_manager_get_context_menu(XfdesktopIconViewManager *manager,
         if (!multi_sel) {
             same_app_infos = TRUE;
         } else if (info != NULL && g_file_info_get_content_type(info) != NULL) {
-            GList *target_app_infos = g_app_info_get_all_for_type(g_file_info_get_content_type(info));
+            GPtrArray *content_types = g_ptr_array_sized_new(g_list_length(selected));
+            g_ptr_array_add(content_types, (gpointer)g_file_info_get_content_type(info));
 
             same_app_infos = TRUE;
             for (GList *l = selected->next; l != NULL; l = l->next) {
@@ -1767,39 +1729,22 @@ xfdesktop_file_icon_manager_get_context_menu(XfdesktopIconViewManager *manager,
                 GFileInfo *icon_info = xfdesktop_file_icon_peek_file_info(icon);
 
                 if (icon_info != NULL) {
-                    if (!XFDESKTOP_IS_REGULAR_FILE_ICON(icon)) {
+                    if (!XFDESKTOP_IS_REGULAR_FILE_ICON(icon) || g_file_info_get_content_type(icon_info) == NULL) {
                         same_app_infos = FALSE;
                         break;
-                    } else if (g_file_info_get_content_type(icon_info) != NULL) {
-                        GList *app_infos = g_app_info_get_all_for_type(g_file_info_get_content_type(icon_info));
-                        GList *tail, *ail;
-
-                        // TODO: This assumes that the app info entries are in the same order.  So far my minimal
-                        // TODO: testing shows that seems to be the case, but not sure if we can rely on that.
-                        for (tail = target_app_infos, ail = app_infos;
-                             tail != NULL && ail != NULL;
-                             tail = tail->next, ail = ail->next)
-                        {
-                            if (!g_app_info_equal(G_APP_INFO(tail->data), G_APP_INFO(ail->data))) {
-                                same_app_infos = FALSE;
-                                break;
-                            }
-                        }
-
-                        g_list_free(app_infos);
-
-                        if (!same_app_infos || tail != NULL || ail != NULL) {
-                            same_app_infos = FALSE;
-                            break;
-                        }
                     } else {
-                        same_app_infos = FALSE;
-                        break;
+                        g_ptr_array_add(content_types, (gpointer)g_file_info_get_content_type(icon_info));
                     }
                 }
             }
 
-            g_list_free_full(target_app_infos, g_object_unref);
+            if (same_app_infos) {
+                same_app_infos = xfdesktop_app_info_cache_share_handlers(fmanager->app_info_cache,
+                                                                         (const gchar *const *)content_types->pdata,
+                                                                         content_types->len);
+            }
+
+            g_ptr_array_free(content_types, TRUE);
         }
 
         if (!same_app_infos) {
@@ -1853,23 +1798,15 @@ xfdesktop_file_icon_manager_get_context_menu(XfdesktopIconViewManager *manager,
                     gtk_menu_set_reserve_toggle_size(GTK_MENU(tmpl_menu), FALSE);
                     gtk_menu_item_set_submenu(GTK_MENU_ITEM(tmpl_mi), tmpl_menu);
 
-                    /* check if XDG_TEMPLATES_DIR="$HOME" and don't show
-                     * templates if so. */
-                    GFile *home_dir = g_file_new_for_path(xfce_get_homedir());
-                    const gchar *templates_dir_path = g_get_user_special_dir(G_USER_DIRECTORY_TEMPLATES);
-                    DBG("templates dir path: %s", templates_dir_path);
-                    GFile *templates_dir = NULL;
-                    if(templates_dir_path) {
-                        templates_dir = g_file_new_for_path(templates_dir_path);
-                    }
-
-                    if(templates_dir && !g_file_equal(home_dir, templates_dir)) {
+                    const XfdesktopTemplateNode *templates_root = fmanager->template_index != NULL
+                        ? xfdesktop_template_index_peek_root(fmanager->template_index)
+                        : NULL;
+                    if (templates_root != NULL) {
                         xfdesktop_file_icon_menu_fill_template_menu(tmpl_menu,
-                                                                    templates_dir,
+                                                                    templates_root,
                                                                     mdata,
                                                                     dest_row,
-                                                                    dest_col,
-                                                                    FALSE);
+                                                                    dest_col);
                     }
 
                     GList *children = gtk_container_get_children(GTK_CONTAINER(tmpl_menu));
@@ -1884,11 +1821,6 @@ xfdesktop_file_icon_manager_get_context_menu(XfdesktopIconViewManager *manager,
                         g_list_free(children);
                     }
 
-                    if (templates_dir) {
-                        g_object_unref(templates_dir);
-                    }
-                    g_object_unref(home_dir);
-
                     add_menu_separator(tmpl_menu);
 
                     /* add the "Empty File" template option */
@@ -2310,8 +2242,10 @@ xfdesktop_file_icon_manager_get_cached_icon_position(XfdesktopFileIconManager *f
     }
 }
 
+// Records the new position without telling the model's views; see
+// update_icon_position().
 static gboolean
-update_icon_position(MonitorData *mdata, XfdesktopFileIcon *icon, gint row, gint col) {
+store_icon_position(MonitorData *mdata, XfdesktopFileIcon *icon, gint row, gint col) {
     XfceDesktop *desktop = xfdesktop_icon_view_holder_get_desktop(mdata->holder);
     XfwMonitor *monitor = xfce_desktop_get_monitor(desktop);
     gboolean changed = xfdesktop_icon_set_monitor(XFDESKTOP_ICON(icon), monitor);
@@ -2326,15 +2260,27 @@ update_icon_position(MonitorData *mdata, XfdesktopFileIcon *icon, gint row, gint
                                                           row,
                                                           col,
                                                           last_seen);
+    }
 
-        GtkTreeIter iter;
-        if (xfdesktop_file_icon_model_get_icon_iter(mdata->fmanager->model, icon, &iter)) {
-            GtkTreePath *path = gtk_tree_model_get_path(GTK_TREE_MODEL(mdata->fmanager->model), &iter);
-            gtk_tree_model_row_changed(GTK_TREE_MODEL(mdata->fmanager->model), path, &iter);
-            gtk_tree_path_free(path);
-        }
+    return changed;
+}
+
+static void
+icon_position_changed(MonitorData *mdata, XfdesktopFileIcon *icon) {
+    GtkTreeIter iter;
+    if (xfdesktop_file_icon_model_get_icon_iter(mdata->fmanager->model, icon, &iter)) {
+        GtkTreePath *path = gtk_tree_model_get_path(GTK_TREE_MODEL(mdata->fmanager->model), &iter);
+        gtk_tree_model_row_changed(GTK_TREE_MODEL(mdata->fmanager->model), path, &iter);
+        gtk_tree_path_free(path);
     }
+}
 
+static gboolean
+update_icon_position(MonitorData *mdata, XfdesktopFileIcon *icon, gint row, gint col) {
+    gboolean changed = store_icon_position(mdata, icon, row, col);
+    if (changed) {
+        icon_position_changed(mdata, icon);
+    }
     return changed;
 }
 
@@ -2700,29 +2646,39 @@ accel_map_changed(XfdesktopFileIconManager *fmanager) {
 }
 
 static void
-xfdesktop_file_icon_manager_clipboard_changed(XfdesktopClipboardManager *cmanager, XfdesktopFileIconManager *fmanager) {
-    GHashTableIter hiter;
-    g_hash_table_iter_init(&hiter, fmanager->monitor_data);
-
-    MonitorData *mdata;
-    while (g_hash_table_iter_next(&hiter, NULL, (gpointer)&mdata)) {
-        XfdesktopIconView *icon_view = xfdesktop_icon_view_holder_get_icon_view(mdata->holder);
-
-        TRACE("entering");
+update_cut_file_sensitivity(XfdesktopFileIconManager *fmanager, GList *files, gboolean sensitive) {
+    for (GList *l = files; l != NULL; l = l->next) {
+        XfdesktopFileIcon *icon = xfdesktop_file_icon_model_get_icon_for_file(fmanager->model, G_FILE(l->data));
+        GtkTreeIter child_iter;
+        if (icon != NULL && xfdesktop_file_icon_model_get_icon_iter(fmanager->model, icon, &child_iter)) {
+            GHashTableIter hiter;
+            g_hash_table_iter_init(&hiter, fmanager->monitor_data);
 
-        GtkTreeIter iter;
-        if (gtk_tree_model_get_iter_first(GTK_TREE_MODEL(mdata->filter), &iter)) {
-            do {
-                XfdesktopFileIcon *icon = xfdesktop_file_icon_model_filter_get_icon(mdata->filter, &iter);
-                if (icon != NULL) {
-                    gboolean is_cut = xfdesktop_clipboard_manager_has_cutted_file(clipboard_manager, icon);
-                    xfdesktop_icon_view_set_item_sensitive(icon_view, &iter, !is_cut);
+            MonitorData *mdata;
+            while (g_hash_table_iter_next(&hiter, NULL, (gpointer)&mdata)) {
+                GtkTreeIter iter;
+                if (gtk_tree_model_filter_convert_child_iter_to_iter(GTK_TREE_MODEL_FILTER(mdata->filter), &iter, &child_iter)) {
+                    XfdesktopIconView *icon_view = xfdesktop_icon_view_holder_get_icon_view(mdata->holder);
+                    xfdesktop_icon_view_set_item_sensitive(icon_view, &iter, sensitive);
                 }
-            } while (gtk_tree_model_iter_next(GTK_TREE_MODEL(mdata->filter), &iter));
+            }
         }
     }
 }
 
+static void
+xfdesktop_file_icon_manager_clipboard_changed(XfdesktopClipboardManager *cmanager,
+                                              GList *added,
+                                              GList *removed,
+                                              XfdesktopFileIconManager *fmanager)
+{
+    TRACE("entering");
+
+    // Only the icons whose cut state actually changed need touching.
+    update_cut_file_sensitivity(fmanager, removed, TRUE);
+    update_cut_file_sensitivity(fmanager, added, FALSE);
+}
+
 static gboolean
 icon_is_writable_directory(XfdesktopFileIcon *icon) {
     GFileInfo *file_info = xfdesktop_file_icon_peek_file_info(icon);
@@ -3774,6 +3730,38 @@ xfdesktop_file_icon_manager_icon_moved(XfdesktopIconView *icon_view,
     }
 }
 
+static void
+xfdesktop_file_icon_manager_icons_moved(XfdesktopIconView *icon_view,
+                                        XfdesktopIconView *source_icon_view,
+                                        GArray *moves,
+                                        MonitorData *mdata)
+{
+    TRACE("entering, %u icons", moves->len);
+
+    MonitorData *source_mdata = source_icon_view == icon_view
+        ? mdata
+        : monitor_data_for_icon_view(mdata->fmanager->monitor_data, source_icon_view);
+    g_return_if_fail(source_mdata != NULL);
+
+    // Record all of the new positions before any row changes, so the
+    // filters see the whole move at once, and the source iters stay valid
+    // (a changed row can drop out of the source filter).
+    GPtrArray *changed = g_ptr_array_sized_new(moves->len);
+    for (guint i = 0; i < moves->len; ++i) {
+        XfdesktopIconMove *move = &g_array_index(moves, XfdesktopIconMove, i);
+        XfdesktopFileIcon *icon = xfdesktop_file_icon_model_filter_get_icon(source_mdata->filter, &move->source_iter);
+        if (G_LIKELY(icon != NULL) && store_icon_position(mdata, icon, move->dest_row, move->dest_col)) {
+            g_ptr_array_add(changed, icon);
+        }
+    }
+
+    for (guint i = 0; i < changed->len; ++i) {
+        icon_position_changed(mdata, g_ptr_array_index(changed, i));
+    }
+
+    g_ptr_array_free(changed, TRUE);
+}
+
 static void
 xfdesktop_file_icon_manager_activate_selected(MonitorData *mdata) {
     XfdesktopIconView *icon_view = xfdesktop_icon_view_holder_get_icon_view(mdata->holder);
@@ -25,9 +25,6 @@
 #include "xfdesktop-file-icon-model.h"
 #include "xfdesktop-icon-position-configs.h"
 #include "xfdesktop-icon.h"
-#include "xfdesktop-regular-file-icon.h"
-#include "xfdesktop-special-file-icon.h"
-#include "xfdesktop-volume-icon.h"
 
 struct _XfdesktopFileIconModelFilter {
     GtkTreeModelFilter parent;
@@ -45,6 +42,8 @@ struct _XfdesktopFileIconModelFilter {
     gboolean show_fixed_device_volumes;
     gboolean show_unknown_volumes;
     gboolean show_hidden_files;
+
+    XfdesktopFileIconCategory visible_categories;
 };
 
 enum {
@@ -78,12 +77,7 @@ static gboolean xfdesktop_file_icon_model_filter_visible(GtkTreeModelFilter *fil
                                                          GtkTreeModel *child_model,
                                                          GtkTreeIter *child_iter);
 
-static gboolean is_special_file_visible(XfdesktopFileIconModelFilter *filter,
-                                        XfdesktopSpecialFileIcon *icon);
-static gboolean is_volume_visible(XfdesktopFileIconModelFilter *filter,
-                                  XfdesktopVolumeIcon *icon);
-static gboolean is_regular_file_visible(XfdesktopFileIconModelFilter *filter,
-                                        XfdesktopRegularFileIcon *icon);
+static void xfdesktop_file_icon_model_filter_settings_changed(XfdesktopFileIconModelFilter *filter);
 
 
 G_DEFINE_TYPE(XfdesktopFileIconModelFilter, xfdesktop_file_icon_model_filter, GTK_TYPE_TREE_MODEL_FILTER)
@@ -214,6 +208,7 @@ xfdesktop_file_icon_model_filter_init(XfdesktopFileIconModelFilter *filter) {
     filter->show_fixed_device_volumes = TRUE;
     filter->show_unknown_volumes = TRUE;
     filter->show_hidden_files = FALSE;
+    xfdesktop_file_icon_model_filter_settings_changed(filter);
 }
 
 static void
@@ -249,47 +244,47 @@ xfdesktop_file_icon_model_filter_set_property(GObject *object, guint property_id
 
         case PROP_SHOW_HOME:
             filter->show_special_home = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_FILESYSTEM:
             filter->show_special_filesystem = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_TRASH:
             filter->show_special_trash = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_REMOVABLE:
             filter->show_removable_media = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_NETWORK_VOLUME:
             filter->show_network_volumes = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_DEVICE_VOLUME:
             filter->show_device_volumes = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_FIXED_DEVICE_VOLUME:
             filter->show_fixed_device_volumes = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_UNKNOWN_VOLUME:
-            filter->show_device_volumes = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            filter->show_unknown_volumes = g_value_get_boolean(value);
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         case PROP_SHOW_HIDDEN_FILES:
             filter->show_hidden_files = g_value_get_boolean(value);
-            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+            xfdesktop_file_icon_model_filter_settings_changed(filter);
             break;
 
         default:
@@ -368,111 +363,58 @@ static gboolean
 xfdesktop_file_icon_model_filter_visible(GtkTreeModelFilter *tmfilter, GtkTreeModel *child_model, GtkTreeIter *child_iter) {
     XfdesktopFileIconModelFilter *filter = XFDESKTOP_FILE_ICON_MODEL_FILTER(tmfilter);
     XfdesktopFileIcon *icon = xfdesktop_file_icon_model_get_icon(XFDESKTOP_FILE_ICON_MODEL(child_model), child_iter);
-    if (icon != NULL) {
+    if (icon != NULL && (xfdesktop_file_icon_get_category(icon) & filter->visible_categories) != 0) {
         const gchar *icon_id = xfdesktop_icon_peek_identifier(XFDESKTOP_ICON(icon));
         XfwMonitor *monitor = NULL;
         gboolean found = xfdesktop_icon_position_configs_lookup(filter->position_configs, icon_id, &monitor, NULL, NULL);
 
         return ((found && monitor == filter->monitor) || (!found && xfw_monitor_is_primary(filter->monitor)))
-            && (
-                (XFDESKTOP_IS_REGULAR_FILE_ICON(icon) && is_regular_file_visible(filter, XFDESKTOP_REGULAR_FILE_ICON(icon)))
-                || (XFDESKTOP_IS_SPECIAL_FILE_ICON(icon) && is_special_file_visible(filter, XFDESKTOP_SPECIAL_FILE_ICON(icon)))
-                || (XFDESKTOP_IS_VOLUME_ICON(icon) && is_volume_visible(filter, XFDESKTOP_VOLUME_ICON(icon)))
-            )
             && GTK_TREE_MODEL_FILTER_CLASS(xfdesktop_file_icon_model_filter_parent_class)->visible(tmfilter, child_model, child_iter);
     } else {
         return FALSE;
     }
 }
 
-static gboolean
-is_special_file_visible(XfdesktopFileIconModelFilter *filter, XfdesktopSpecialFileIcon *icon) {
-    switch (xfdesktop_special_file_icon_get_icon_type(icon)) {
-        case XFDESKTOP_SPECIAL_FILE_ICON_HOME:
-            return filter->show_special_home;
-        case XFDESKTOP_SPECIAL_FILE_ICON_FILESYSTEM:
-            return filter->show_special_filesystem;
-        case XFDESKTOP_SPECIAL_FILE_ICON_TRASH:
-            return filter->show_special_trash;
-        default:
-            g_assert_not_reached();
-            return FALSE;
+static void
+xfdesktop_file_icon_model_filter_settings_changed(XfdesktopFileIconModelFilter *filter) {
+    XfdesktopFileIconCategory categories = XFDESKTOP_FILE_ICON_CATEGORY_REGULAR_FILE;
+
+    if (filter->show_hidden_files) {
+        categories |= XFDESKTOP_FILE_ICON_CATEGORY_HIDDEN_FILE;
+    }
+
+    if (filter->show_special_home) {
+        categories |= XFDESKTOP_FILE_ICON_CATEGORY_HOME;
+    }
+    if (filter->show_special_filesystem) {
+        categories |= XFDESKTOP_FILE_ICON_CATEGORY_FILESYSTEM;
+    }
+    if (filter->show_special_trash) {
+        categories |= XFDESKTOP_FILE_ICON_CATEGORY_TRASH;
     }
-}
 
-static gboolean
-is_volume_visible(XfdesktopFileIconModelFilter *filter, XfdesktopVolumeIcon *icon) {
     if (filter->show_removable_media) {
-        gboolean visible;
-
-        GVolume *volume = xfdesktop_volume_icon_peek_volume(icon);
-        if (volume != NULL) {
-            gboolean is_removable = g_volume_can_eject(volume);
-            if (!is_removable) {
-                GDrive *drive = g_volume_get_drive(volume);
-                if (drive != NULL) {
-                    is_removable = g_drive_is_removable(drive);
-                    g_object_unref(drive);
-                }
-            }
-
-            gchar *volume_type = g_volume_get_identifier(volume, G_VOLUME_IDENTIFIER_KIND_CLASS);
-            gboolean is_device = g_strcmp0(volume_type, "device") == 0;
-            visible = (filter->show_network_volumes && g_strcmp0(volume_type, "network") == 0)
-                || (filter->show_device_volumes && is_removable && is_device)
-                || (filter->show_fixed_device_volumes && !is_removable && is_device)
-                || (filter->show_unknown_volumes && (volume_type == NULL || g_strcmp0(volume_type, "loop") == 0));
-            g_free(volume_type);
-        } else {
-            GMount *mount = xfdesktop_volume_icon_peek_mount(icon);
-            if (mount != NULL) {
-                gboolean is_removable;
-                gboolean is_local;
-                gboolean is_ignored_scheme;
-
-                GFile *root = g_mount_get_root(mount);
-                if (root != NULL) {
-                    is_ignored_scheme =
-                        g_file_has_uri_scheme(root, "gphoto2")
-                        || g_file_has_uri_scheme(root, "mtp")
-                        || g_file_has_uri_scheme(root, "cdda");
-                    g_object_unref(root);
-                } else {
-                    is_ignored_scheme = FALSE;
-                }
-
-                GDrive *drive = g_mount_get_drive(mount);
-                if (drive != NULL) {
-                    is_removable = g_drive_is_removable(drive) || g_mount_can_eject(mount);
-
-                    gchar *unix_device = g_drive_get_identifier(drive, G_DRIVE_IDENTIFIER_KIND_UNIX_DEVICE);
-                    is_local = unix_device != NULL && unix_device[0] != '\0';
-                    g_free(unix_device);
-
-                    g_object_unref(drive);
-                } else {
-                    is_removable = g_mount_can_eject(mount);
-                    is_local = FALSE;  // Very weak guess, maybe should look at URI
-                }
-
-                visible = !is_ignored_scheme
-                    && (is_removable
-                        || (is_local && (filter->show_device_volumes || filter->show_fixed_device_volumes))
-                        || (!is_local && filter->show_network_volumes));
-            } else {
-                visible = FALSE;
-            }
+        categories |= XFDESKTOP_FILE_ICON_CATEGORY_REMOVABLE_MOUNT;
+        if (filter->show_network_volumes) {
+            categories |= XFDESKTOP_FILE_ICON_CATEGORY_NETWORK_VOLUME | XFDESKTOP_FILE_ICON_CATEGORY_NETWORK_MOUNT;
+        }
+        if (filter->show_device_volumes) {
+            categories |= XFDESKTOP_FILE_ICON_CATEGORY_REMOVABLE_DEVICE_VOLUME | XFDESKTOP_FILE_ICON_CATEGORY_LOCAL_MOUNT;
+        }
+        if (filter->show_fixed_device_volumes) {
+            categories |= XFDESKTOP_FILE_ICON_CATEGORY_FIXED_DEVICE_VOLUME | XFDESKTOP_FILE_ICON_CATEGORY_LOCAL_MOUNT;
+        }
+        if (filter->show_unknown_volumes) {
+            categories |= XFDESKTOP_FILE_ICON_CATEGORY_UNKNOWN_VOLUME;
         }
-
-        return visible;
-    } else {
-        return FALSE;
     }
-}
 
-static gboolean
-is_regular_file_visible(XfdesktopFileIconModelFilter *filter, XfdesktopRegularFileIcon *icon) {
-    return filter->show_hidden_files || !xfdesktop_file_icon_is_hidden_file(XFDESKTOP_FILE_ICON(icon));
+    if (categories != filter->visible_categories) {
+        filter->visible_categories = categories;
+        if (gtk_tree_model_filter_get_model(GTK_TREE_MODEL_FILTER(filter)) != NULL) {
+            gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
+        }
+    }
 }
 
 XfdesktopFileIconModelFilter *
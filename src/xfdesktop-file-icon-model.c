@@ -31,6 +31,7 @@
 #include "xfdesktop-marshal.h"
 #include "xfdesktop-regular-file-icon.h"
 #include "xfdesktop-special-file-icon.h"
+#include "xfdesktop-startup-trace.h"
 #include "xfdesktop-thumbnailer.h"
 #include "xfdesktop-volume-icon.h"
 
@@ -1134,9 +1135,11 @@ enumerator_files_ready(GFileEnumerator *enumerator, GAsyncResult *result, Xfdesk
     if (files == NULL && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
         DBG("cancelled");
         g_error_free(error);
+        xfdesktop_startup_trace_end("file-icon-model-populate");
     } else if (files == NULL) {
         g_file_enumerator_close_async(enumerator, G_PRIORITY_DEFAULT_IDLE, NULL, enumerator_close_done, NULL);
         g_clear_object(&fmodel->enumerator);
+        xfdesktop_startup_trace_end("file-icon-model-populate");
 
         if (error != NULL) {
             GError *error2 = g_error_new_literal(XFDESKTOP_FILE_ICON_MODEL_ERROR,
@@ -1210,6 +1213,7 @@ file_enumerator_ready(GFile *file, GAsyncResult *result, XfdesktopFileIconModel
             }
             g_error_free(error);
         }
+        xfdesktop_startup_trace_end("file-icon-model-populate");
     } else {
         g_clear_object(&fmodel->enumerator);
         fmodel->enumerator = enumerator;
@@ -1344,6 +1348,7 @@ xfdesktop_file_icon_model_reload(XfdesktopFileIconModel *fmodel) {
 
         load_removable_media(fmodel);
 
+        xfdesktop_startup_trace_begin("file-icon-model-populate");
         g_file_enumerate_children_async(fmodel->folder,
                                         XFDESKTOP_FILE_INFO_NAMESPACE,
                                         G_FILE_QUERY_INFO_NONE,
@@ -32,6 +32,8 @@ typedef struct _XfdesktopFileIconPrivate
 {
     GIcon *gicon;
     gchar *sort_key;
+    XfdesktopFileIconCategory category;
+    gboolean category_valid;
 } XfdesktopFileIconPrivate;
 
 static void xfdesktop_file_icon_finalize(GObject *obj);
@@ -239,6 +241,8 @@ xfdesktop_file_icon_update_file_info(XfdesktopFileIcon *icon,
 
     klass = XFDESKTOP_FILE_ICON_GET_CLASS(icon);
 
+    xfdesktop_file_icon_invalidate_category(icon);
+
     if(klass->update_file_info)
        klass->update_file_info(icon, info);
 }
@@ -285,6 +289,30 @@ xfdesktop_file_icon_is_hidden_file(XfdesktopFileIcon *icon) {
     }
 }
 
+XfdesktopFileIconCategory
+xfdesktop_file_icon_get_category(XfdesktopFileIcon *icon) {
+    g_return_val_if_fail(XFDESKTOP_IS_FILE_ICON(icon), XFDESKTOP_FILE_ICON_CATEGORY_NONE);
+
+    XfdesktopFileIconPrivate *priv = GET_PRIVATE(icon);
+    if (!priv->category_valid) {
+        XfdesktopFileIconClass *klass = XFDESKTOP_FILE_ICON_GET_CLASS(icon);
+        if (klass->get_category != NULL) {
+            priv->category = klass->get_category(icon);
+        } else {
+            priv->category = XFDESKTOP_FILE_ICON_CATEGORY_NONE;
+        }
+        priv->category_valid = TRUE;
+    }
+
+    return priv->category;
+}
+
+void
+xfdesktop_file_icon_invalidate_category(XfdesktopFileIcon *icon) {
+    g_return_if_fail(XFDESKTOP_IS_FILE_ICON(icon));
+    GET_PRIVATE(icon)->category_valid = FALSE;
+}
+
 GIcon *
 xfdesktop_file_icon_add_emblems(XfdesktopFileIcon *icon,
                                 GIcon *gicon)
@@ -29,6 +29,29 @@
 
 G_BEGIN_DECLS
 
+/**
+ * XfdesktopFileIconCategory:
+ *
+ * What kind of thing an icon represents, as far as deciding whether or not
+ * to show it goes.  Computed once per icon and cached until the icon's file
+ * info, volume or mount changes.
+ **/
+typedef enum {
+    XFDESKTOP_FILE_ICON_CATEGORY_NONE = 0,
+    XFDESKTOP_FILE_ICON_CATEGORY_REGULAR_FILE = 1 << 0,
+    XFDESKTOP_FILE_ICON_CATEGORY_HIDDEN_FILE = 1 << 1,
+    XFDESKTOP_FILE_ICON_CATEGORY_HOME = 1 << 2,
+    XFDESKTOP_FILE_ICON_CATEGORY_FILESYSTEM = 1 << 3,
+    XFDESKTOP_FILE_ICON_CATEGORY_TRASH = 1 << 4,
+    XFDESKTOP_FILE_ICON_CATEGORY_NETWORK_VOLUME = 1 << 5,
+    XFDESKTOP_FILE_ICON_CATEGORY_REMOVABLE_DEVICE_VOLUME = 1 << 6,
+    XFDESKTOP_FILE_ICON_CATEGORY_FIXED_DEVICE_VOLUME = 1 << 7,
+    XFDESKTOP_FILE_ICON_CATEGORY_UNKNOWN_VOLUME = 1 << 8,
+    XFDESKTOP_FILE_ICON_CATEGORY_REMOVABLE_MOUNT = 1 << 9,
+    XFDESKTOP_FILE_ICON_CATEGORY_LOCAL_MOUNT = 1 << 10,
+    XFDESKTOP_FILE_ICON_CATEGORY_NETWORK_MOUNT = 1 << 11,
+} XfdesktopFileIconCategory;
+
 G_DECLARE_DERIVABLE_TYPE(XfdesktopFileIcon, xfdesktop_file_icon, XFDESKTOP, FILE_ICON, XfdesktopIcon)
 #define XFDESKTOP_TYPE_FILE_ICON (xfdesktop_file_icon_get_type())
 
@@ -48,6 +71,7 @@ struct _XfdesktopFileIconClass
     gboolean (*can_rename_file)(XfdesktopFileIcon *icon);
     gboolean (*can_delete_file)(XfdesktopFileIcon *icon);
     gboolean (*is_hidden_file)(XfdesktopFileIcon *icon);
+    XfdesktopFileIconCategory (*get_category)(XfdesktopFileIcon *icon);
 
     guint (*hash)(XfdesktopFileIcon *icon);
     gchar *(*get_sort_key)(XfdesktopFileIcon *icon);
@@ -65,6 +89,9 @@ gboolean xfdesktop_file_icon_can_delete_file(XfdesktopFileIcon *icon);
 
 gboolean xfdesktop_file_icon_is_hidden_file(XfdesktopFileIcon *icon);
 
+XfdesktopFileIconCategory xfdesktop_file_icon_get_category(XfdesktopFileIcon *icon);
+void xfdesktop_file_icon_invalidate_category(XfdesktopFileIcon *icon);
+
 GIcon *xfdesktop_file_icon_add_emblems(XfdesktopFileIcon *icon,
                                        GIcon *gicon);
 
@@ -29,6 +29,7 @@
 #include <unistd.h>
 #include <yaml.h>
 
+#include "xfdesktop-common.h"
 #include "xfdesktop-icon-position-configs.h"
 
 #define SAVE_DELAY_S 1
@@ -78,18 +79,44 @@ G_STMT_END
 
 #define EMITTER_ERROR(emitter, event)
 
+// Shared between the configs and any in-flight save tasks, so that an older
+// snapshot finishing late never overwrites a newer one on disk.
+typedef struct _SaveWriter {
+    GMutex lock;
+    guint64 last_written_id;
+} SaveWriter;
+
 struct _XfdesktopIconPositionConfigs {
     GFile *file;
     GList *configs;  // XfdesktopIconPositionConfig (owner)
     GHashTable *config_to_monitor;  // XfdesktopIconPositionConfig -> XfwMonitor
+    // Reverse index over every config in 'configs', so finding where an icon
+    // lives doesn't mean walking each config in turn.  Entries are kept in
+    // the order their configs were indexed, so ties between configs of the
+    // same level resolve the same way every time.
+    GHashTable *icon_index;  // string id (owner) -> GArray of IconIndexEntry (owner)
 
     guint scheduled_save_id;
+    SaveWriter *writer;
+    guint64 last_snapshot_id;
+    GCancellable *cancellable;
+    gboolean save_in_progress;
+    gboolean save_pending;
 };
 
 struct _XfdesktopIconPositionConfig {
     XfdesktopIconPositionLevel level;
     GHashTable *monitors;  // string id (owner) -> XfdesktopIconPositionMonitor (owner)
     GHashTable *icon_positions;  // string id (owner) -> XfdesktopIconPosition (owner)
+    gboolean indexed;  // TRUE while part of the configs' icon_index
+
+    // Bumped on every change; the config is dirty when it no longer matches
+    // 'cached_serial', the serial 'serialized' (YAML) and 'packed' (binary
+    // cache record) were generated from.  Either may be NULL.
+    guint64 serial;
+    GBytes *serialized;
+    GBytes *packed;
+    guint64 cached_serial;
 };
 
 typedef struct _XfdesktopIconPositionMonitor {
@@ -103,6 +130,96 @@ typedef struct _XfdesktopIconPosition {
     guint64 last_seen;
 } XfdesktopIconPosition;
 
+typedef struct _IconIndexEntry {
+    XfdesktopIconPositionConfig *config;
+    XfdesktopIconPosition *position;  // owned by config->icon_positions
+} IconIndexEntry;
+
+typedef struct _SnapshotSection {
+    XfdesktopIconPositionConfig *config;  // identity only; never dereferenced off the main thread
+    guint64 serial;
+    XfdesktopIconPositionConfig *copy;  // (owner), NULL when 'serialized' was cached
+    GBytes *serialized;  // (owner)
+    GBytes *packed;  // (owner)
+} SnapshotSection;
+
+typedef struct _SaveSnapshot {
+    SaveWriter *writer;
+    guint64 id;
+    gchar *filename;
+    GPtrArray *sections;  // SnapshotSection (owner), in config order
+    guint n_dirty;
+
+    // When FALSE, only the binary cache is written, and only if the YAML
+    // file still matches yaml_mtime and yaml_size.
+    gboolean write_yaml;
+    guint64 yaml_mtime;
+    guint64 yaml_size;
+} SaveSnapshot;
+
+/*
+ * The binary cache lives next to the YAML file, and is only ever a faster
+ * way to load it: it records the YAML's mtime and size, and is ignored if
+ * either doesn't match.  All integers are in host byte order (the cache is
+ * never shared between machines), and all records are 8-byte aligned so
+ * they can be read directly out of the mapped file.
+ *
+ *   PositionCacheHeader
+ *   PackedConfig, PackedMonitor[n_monitors], PackedIcon[n_icons]  (x n_configs)
+ *   string table (NUL-terminated, deduplicated)
+ *
+ * In memory, each config's 'packed' record is laid out the same way, except
+ * that it is followed by its own string pool, which is merged into the
+ * file's string table when the cache is written.
+ */
+#define POSITION_CACHE_SUFFIX ".cache"
+#define POSITION_CACHE_MAGIC "XFDPOSC"
+#define POSITION_CACHE_VERSION 1
+#define POSITION_CACHE_BYTE_ORDER 0x01020304
+#define POSITION_CACHE_NO_STRING G_MAXUINT32
+
+typedef struct _PositionCacheHeader {
+    gchar magic[8];
+    guint32 version;
+    guint32 byte_order;
+    guint64 yaml_mtime;  // microseconds
+    guint64 yaml_size;
+    guint64 data_len;  // config records following the header
+    guint32 strings_len;  // string table following the config records
+    guint32 n_configs;
+    guint8 checksum[20];  // SHA-1 over the config records and string table
+    guint32 padding;
+} PositionCacheHeader;
+
+typedef struct _PackedConfig {
+    gint32 level;
+    guint32 n_monitors;
+    guint32 n_icons;
+    guint32 strings_len;  // in-memory records only; always 0 on disk
+} PackedConfig;
+
+typedef struct _PackedMonitor {
+    guint32 id;  // string offset
+    guint32 display_name;  // string offset
+    gint32 x;
+    gint32 y;
+    gint32 width;
+    gint32 height;
+} PackedMonitor;
+
+typedef struct _PackedIcon {
+    guint32 id;  // string offset
+    guint32 row;
+    guint32 col;
+    guint32 padding;
+    guint64 last_seen;
+} PackedIcon;
+
+G_STATIC_ASSERT(sizeof(PositionCacheHeader) % 8 == 0);
+G_STATIC_ASSERT(sizeof(PackedConfig) % 8 == 0);
+G_STATIC_ASSERT(sizeof(PackedMonitor) % 8 == 0);
+G_STATIC_ASSERT(sizeof(PackedIcon) % 8 == 0);
+
 typedef enum {
     PARSER_TOP,
     PARSER_TOPLEVEL_MAP,
@@ -233,6 +350,85 @@ xfdesktop_icon_position_monitor_free(XfdesktopIconPositionMonitor *pos_monitor)
     }
 }
 
+static void
+config_mark_dirty(XfdesktopIconPositionConfig *config) {
+    // Only ever touched from the main thread.
+    static guint64 next_serial = 0;
+    config->serial = ++next_serial;
+}
+
+static void
+icon_index_add(XfdesktopIconPositionConfigs *configs,
+               XfdesktopIconPositionConfig *config,
+               const gchar *icon_id,
+               XfdesktopIconPosition *position)
+{
+    GArray *entries = g_hash_table_lookup(configs->icon_index, icon_id);
+    if (entries == NULL) {
+        entries = g_array_sized_new(FALSE, FALSE, sizeof(IconIndexEntry), 1);
+        g_hash_table_insert(configs->icon_index, g_strdup(icon_id), entries);
+    } else {
+        for (guint i = 0; i < entries->len; ++i) {
+            IconIndexEntry *entry = &g_array_index(entries, IconIndexEntry, i);
+            if (entry->config == config) {
+                entry->position = position;
+                return;
+            }
+        }
+    }
+
+    IconIndexEntry entry = {
+        .config = config,
+        .position = position,
+    };
+    g_array_append_val(entries, entry);
+}
+
+static void
+icon_index_remove(XfdesktopIconPositionConfigs *configs,
+                  XfdesktopIconPositionConfig *config,
+                  const gchar *icon_id)
+{
+    GArray *entries = g_hash_table_lookup(configs->icon_index, icon_id);
+    if (entries != NULL) {
+        for (guint i = 0; i < entries->len; ++i) {
+            if (g_array_index(entries, IconIndexEntry, i).config == config) {
+                g_array_remove_index(entries, i);
+                break;
+            }
+        }
+
+        if (entries->len == 0) {
+            g_hash_table_remove(configs->icon_index, icon_id);
+        }
+    }
+}
+
+static void
+icon_index_add_config(XfdesktopIconPositionConfigs *configs, XfdesktopIconPositionConfig *config) {
+    GHashTableIter iter;
+    g_hash_table_iter_init(&iter, config->icon_positions);
+
+    const gchar *icon_id;
+    XfdesktopIconPosition *position;
+    while (g_hash_table_iter_next(&iter, (gpointer)&icon_id, (gpointer)&position)) {
+        icon_index_add(configs, config, icon_id, position);
+    }
+    config->indexed = TRUE;
+}
+
+static void
+icon_index_remove_config(XfdesktopIconPositionConfigs *configs, XfdesktopIconPositionConfig *config) {
+    GHashTableIter iter;
+    g_hash_table_iter_init(&iter, config->icon_positions);
+
+    const gchar *icon_id;
+    while (g_hash_table_iter_next(&iter, (gpointer)&icon_id, NULL)) {
+        icon_index_remove(configs, config, icon_id);
+    }
+    config->indexed = FALSE;
+}
+
 static XfdesktopIconPositionConfig *
 xfdesktop_icon_position_config_new_internal(XfdesktopIconPositionLevel level) {
     g_return_val_if_fail(level >= XFDESKTOP_ICON_POSITION_LEVEL_INVALID && level <= XFDESKTOP_ICON_POSITION_LEVEL_OTHER, NULL);
@@ -241,11 +437,55 @@ xfdesktop_icon_position_config_new_internal(XfdesktopIconPositionLevel level) {
     config->level = level;
     config->monitors = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)xfdesktop_icon_position_monitor_free);
     config->icon_positions = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    config_mark_dirty(config);
     return config;
 }
 
 static gboolean
-save_icons(XfdesktopIconPositionConfigs *configs, GError **error) {
+config_is_dirty(XfdesktopIconPositionConfig *config) {
+    return config->serialized == NULL || config->cached_serial != config->serial;
+}
+
+static GBytes *
+config_peek_packed(XfdesktopIconPositionConfig *config) {
+    return config->cached_serial == config->serial ? config->packed : NULL;
+}
+
+static XfdesktopIconPositionConfig *
+config_copy_for_save(XfdesktopIconPositionConfig *config) {
+    XfdesktopIconPositionConfig *copy = xfdesktop_icon_position_config_new_internal(config->level);
+
+    GHashTableIter iter;
+    g_hash_table_iter_init(&iter, config->monitors);
+    const gchar *id;
+    XfdesktopIconPositionMonitor *pos_monitor;
+    while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&pos_monitor)) {
+        XfdesktopIconPositionMonitor *monitor_copy = g_new0(XfdesktopIconPositionMonitor, 1);
+        monitor_copy->display_name = g_strdup(pos_monitor->display_name);
+        monitor_copy->geometry = pos_monitor->geometry;
+        g_hash_table_insert(copy->monitors, g_strdup(id), monitor_copy);
+    }
+
+    g_hash_table_iter_init(&iter, config->icon_positions);
+    XfdesktopIconPosition *position;
+    while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&position)) {
+        g_hash_table_insert(copy->icon_positions, g_strdup(id), g_memdup2(position, sizeof(*position)));
+    }
+
+    return copy;
+}
+
+static int
+emit_to_gstring(void *data, unsigned char *buffer, size_t size) {
+    g_string_append_len((GString *)data, (const gchar *)buffer, size);
+    return 1;
+}
+
+// Serializes a single config as one item of the toplevel 'configs' sequence,
+// already indented, so the result can be concatenated with the (possibly
+// cached) output for the other configs when writing the file.
+static GBytes *
+serialize_config(XfdesktopIconPositionConfig *config, GError **error) {
     yaml_emitter_t emitter;
     if (!yaml_emitter_initialize(&emitter)) {
         g_set_error(error,
@@ -253,26 +493,13 @@ save_icons(XfdesktopIconPositionConfigs *configs, GError **error) {
                     G_IO_ERROR_FAILED,
                     "Failed to create YAML emitter: %s",
                     libyaml_strerror(emitter.error));
-        return FALSE;
+        return NULL;
     }
 
-    gchar *new_filename = g_strconcat(g_file_peek_path(configs->file), ".new", NULL);
-    FILE *output = fopen(new_filename, "wb");
-    if (output == NULL) {
-        g_set_error(error,
-                    G_IO_ERROR,
-                    g_io_error_from_errno(errno),
-                    "Failed to open '%s' for writing: %s",
-                    new_filename,
-                    strerror(errno));
-        yaml_emitter_delete(&emitter);
-        g_free(new_filename);
-        return FALSE;
-    }
-
-    fputs("#\n# DO NOT EDIT THIS FILE WHILE XFDESKTOP IS RUNNING\n#\n", output);
-
-    yaml_emitter_set_output_file(&emitter, output);
+    GString *output = g_string_sized_new(64 + g_hash_table_size(config->icon_positions) * 64);
+    yaml_emitter_set_output(&emitter, emit_to_gstring, output);
+    // Don't let libyaml fold long quoted scalars; we re-indent line by line.
+    yaml_emitter_set_width(&emitter, -1);
 
     yaml_event_t event;
 
@@ -282,7 +509,7 @@ save_icons(XfdesktopIconPositionConfigs *configs, GError **error) {
             g_set_error(error, \
                         G_IO_ERROR, \
                         G_IO_ERROR_FAILED, \
-                        "Failed to emit YAML to file: %s", \
+                        "Failed to emit YAML: %s", \
                         libyaml_strerror(emitter.error)); \
             goto out_err; \
         } \
@@ -304,26 +531,26 @@ G_STMT_END
 G_STMT_END
 #define EMIT_INT_EVENT(emitter, event, val) \
     G_STMT_START { \
-        gchar *val_str = g_strdup_printf("%d", val); \
+        gchar val_str[G_ASCII_DTOSTR_BUF_SIZE]; \
+        g_snprintf(val_str, sizeof(val_str), "%d", val); \
         yaml_scalar_event_initialize(&event, NULL, YC("tag:yaml.org,2002:int"), YC(val_str), strlen(val_str), TRUE, TRUE, YAML_PLAIN_SCALAR_STYLE); \
         EMIT(emitter, event); \
-        g_free(val_str); \
     } \
 G_STMT_END
 #define EMIT_UINT_EVENT(emitter, event, val) \
     G_STMT_START { \
-        gchar *val_str = g_strdup_printf("%u", val); \
+        gchar val_str[G_ASCII_DTOSTR_BUF_SIZE]; \
+        g_snprintf(val_str, sizeof(val_str), "%u", val); \
         yaml_scalar_event_initialize(&event, NULL, YC("tag:yaml.org,2002:int"), YC(val_str), strlen(val_str), TRUE, TRUE, YAML_PLAIN_SCALAR_STYLE); \
         EMIT(emitter, event); \
-        g_free(val_str); \
     } \
 G_STMT_END
 #define EMIT_UINT64_EVENT(emitter, event, val) \
     G_STMT_START { \
-        gchar *val_str = g_strdup_printf("%" G_GUINT64_FORMAT, val); \
+        gchar val_str[G_ASCII_DTOSTR_BUF_SIZE]; \
+        g_snprintf(val_str, sizeof(val_str), "%" G_GUINT64_FORMAT, val); \
         yaml_scalar_event_initialize(&event, NULL, YC("tag:yaml.org,2002:int"), YC(val_str), strlen(val_str), TRUE, TRUE, YAML_PLAIN_SCALAR_STYLE); \
         EMIT(emitter, event); \
-        g_free(val_str); \
     } \
 G_STMT_END
 #define EMIT_MAP_START_EVENT(emitter, event) \
@@ -347,84 +574,37 @@ G_STMT_END
         {
             EMIT_MAP_START_EVENT(emitter, event);
             {
-                EMIT_UQSTR_EVENT(emitter, event, "configs");
+                EMIT_UQSTR_EVENT(emitter, event, "level");
+                EMIT_INT_EVENT(emitter, event, config->level);
+
+                EMIT_UQSTR_EVENT(emitter, event, "monitors");
                 EMIT_SEQ_START_EVENT(emitter, event);
                 {
-                    for (GList *l = configs->configs; l != NULL; l = l->next) {
-                        XfdesktopIconPositionConfig *config = l->data;
+                    GHashTableIter iter;
+                    g_hash_table_iter_init(&iter, config->monitors);
 
+                    const gchar *id;
+                    XfdesktopIconPositionMonitor *pos_monitor;
+                    while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&pos_monitor)) {
                         EMIT_MAP_START_EVENT(emitter, event);
                         {
-                            EMIT_UQSTR_EVENT(emitter, event, "level");
-                            EMIT_INT_EVENT(emitter, event, config->level);
+                            EMIT_UQSTR_EVENT(emitter, event, "id");
+                            EMIT_QSTR_EVENT(emitter, event, id);
 
-                            EMIT_UQSTR_EVENT(emitter, event, "monitors");
-                            EMIT_SEQ_START_EVENT(emitter, event);
-                            {
-                                GHashTableIter iter;
-                                g_hash_table_iter_init(&iter, config->monitors);
-
-                                const gchar *id;
-                                XfdesktopIconPositionMonitor *pos_monitor;
-                                while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&pos_monitor)) {
-                                    EMIT_MAP_START_EVENT(emitter, event);
-                                    {
-                                        EMIT_UQSTR_EVENT(emitter, event, "id");
-                                        EMIT_QSTR_EVENT(emitter, event, id);
-
-                                        EMIT_UQSTR_EVENT(emitter, event, "display_name");
-                                        EMIT_QSTR_EVENT(emitter, event, pos_monitor->display_name);
-
-                                        EMIT_UQSTR_EVENT(emitter, event, "geometry");
-                                        EMIT_MAP_START_EVENT(emitter, event);
-                                        {
-                                            EMIT_UQSTR_EVENT(emitter, event, "x");
-                                            EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.x);
-                                            EMIT_UQSTR_EVENT(emitter, event, "y");
-                                            EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.y);
-                                            EMIT_UQSTR_EVENT(emitter, event, "width");
-                                            EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.width);
-                                            EMIT_UQSTR_EVENT(emitter, event, "height");
-                                            EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.height);
-
-                                            yaml_mapping_end_event_initialize(&event);
-                                            EMIT(emitter, event);
-                                        }
-
-                                        yaml_mapping_end_event_initialize(&event);
-                                        EMIT(emitter, event);
-                                    }
-                                }
-
-                                yaml_sequence_end_event_initialize(&event);
-                                EMIT(emitter, event);
-                            }
+                            EMIT_UQSTR_EVENT(emitter, event, "display_name");
+                            EMIT_QSTR_EVENT(emitter, event, pos_monitor->display_name);
 
-                            EMIT_UQSTR_EVENT(emitter, event, "icons");
+                            EMIT_UQSTR_EVENT(emitter, event, "geometry");
                             EMIT_MAP_START_EVENT(emitter, event);
                             {
-                                GHashTableIter iter;
-                                g_hash_table_iter_init(&iter, config->icon_positions);
-
-                                const gchar *id;
-                                XfdesktopIconPosition *position;
-                                while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&position)) {
-                                    EMIT_QSTR_EVENT(emitter, event, id);
-                                    EMIT_MAP_START_EVENT(emitter, event);
-                                    {
-                                        EMIT_UQSTR_EVENT(emitter, event, "row");
-                                        EMIT_UINT_EVENT(emitter, event, position->row);
-                                        EMIT_UQSTR_EVENT(emitter, event, "col");
-                                        EMIT_UINT_EVENT(emitter, event, position->col);
-                                        if (position->last_seen != 0) {
-                                            EMIT_UQSTR_EVENT(emitter, event, "last_seen");
-                                            EMIT_UINT64_EVENT(emitter, event, position->last_seen);
-                                        }
-
-                                        yaml_mapping_end_event_initialize(&event);
-                                        EMIT(emitter, event);
-                                    }
-                                }
+                                EMIT_UQSTR_EVENT(emitter, event, "x");
+                                EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.x);
+                                EMIT_UQSTR_EVENT(emitter, event, "y");
+                                EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.y);
+                                EMIT_UQSTR_EVENT(emitter, event, "width");
+                                EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.width);
+                                EMIT_UQSTR_EVENT(emitter, event, "height");
+                                EMIT_INT_EVENT(emitter, event, pos_monitor->geometry.height);
 
                                 yaml_mapping_end_event_initialize(&event);
                                 EMIT(emitter, event);
@@ -439,6 +619,36 @@ G_STMT_END
                     EMIT(emitter, event);
                 }
 
+                EMIT_UQSTR_EVENT(emitter, event, "icons");
+                EMIT_MAP_START_EVENT(emitter, event);
+                {
+                    GHashTableIter iter;
+                    g_hash_table_iter_init(&iter, config->icon_positions);
+
+                    const gchar *id;
+                    XfdesktopIconPosition *position;
+                    while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&position)) {
+                        EMIT_QSTR_EVENT(emitter, event, id);
+                        EMIT_MAP_START_EVENT(emitter, event);
+                        {
+                            EMIT_UQSTR_EVENT(emitter, event, "row");
+                            EMIT_UINT_EVENT(emitter, event, position->row);
+                            EMIT_UQSTR_EVENT(emitter, event, "col");
+                            EMIT_UINT_EVENT(emitter, event, position->col);
+                            if (position->last_seen != 0) {
+                                EMIT_UQSTR_EVENT(emitter, event, "last_seen");
+                                EMIT_UINT64_EVENT(emitter, event, position->last_seen);
+                            }
+
+                            yaml_mapping_end_event_initialize(&event);
+                            EMIT(emitter, event);
+                        }
+                    }
+
+                    yaml_mapping_end_event_initialize(&event);
+                    EMIT(emitter, event);
+                }
+
                 yaml_mapping_end_event_initialize(&event);
                 EMIT(emitter, event);
             }
@@ -462,6 +672,498 @@ G_STMT_END
 #undef YC
 
     yaml_emitter_delete(&emitter);
+
+    // Turn the standalone map document into a sequence item: the first line
+    // gets the "- " marker, and everything else is indented to match.
+    GString *section = g_string_sized_new(output->len + output->len / 8);
+    gchar **lines = g_strsplit(output->str, "\n", -1);
+    gboolean first = TRUE;
+    for (gchar **line = lines; *line != NULL; ++line) {
+        if (**line == '\0' || strcmp(*line, "---") == 0 || strcmp(*line, "...") == 0) {
+            continue;
+        }
+        g_string_append(section, first ? "- " : "  ");
+        g_string_append(section, *line);
+        g_string_append_c(section, '\n');
+        first = FALSE;
+    }
+    g_strfreev(lines);
+    g_string_free(output, TRUE);
+
+    return g_string_free_to_bytes(section);
+
+out_err:
+    yaml_emitter_delete(&emitter);
+    g_string_free(output, TRUE);
+    return NULL;
+}
+
+static guint32
+pack_string(GString *strings, const gchar *str) {
+    if (str == NULL) {
+        return POSITION_CACHE_NO_STRING;
+    } else {
+        guint32 offset = strings->len;
+        g_string_append_len(strings, str, strlen(str) + 1);
+        return offset;
+    }
+}
+
+// Packs a config into its binary cache record, followed by its own string
+// pool.  Cheap enough to run on the main thread.
+static GBytes *
+pack_config(XfdesktopIconPositionConfig *config) {
+    guint n_monitors = g_hash_table_size(config->monitors);
+    guint n_icons = g_hash_table_size(config->icon_positions);
+    gsize records_len = sizeof(PackedConfig) + n_monitors * sizeof(PackedMonitor) + n_icons * sizeof(PackedIcon);
+    GString *strings = g_string_sized_new(n_icons * 32);
+
+    guint8 *data = g_malloc0(records_len);
+    PackedConfig *pconfig = (PackedConfig *)data;
+    PackedMonitor *pmonitor = (PackedMonitor *)(pconfig + 1);
+    pconfig->level = config->level;
+    pconfig->n_monitors = n_monitors;
+    pconfig->n_icons = n_icons;
+
+    GHashTableIter iter;
+    g_hash_table_iter_init(&iter, config->monitors);
+    const gchar *id;
+    XfdesktopIconPositionMonitor *pos_monitor;
+    while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&pos_monitor)) {
+        pmonitor->id = pack_string(strings, id);
+        pmonitor->display_name = pack_string(strings, pos_monitor->display_name);
+        pmonitor->x = pos_monitor->geometry.x;
+        pmonitor->y = pos_monitor->geometry.y;
+        pmonitor->width = pos_monitor->geometry.width;
+        pmonitor->height = pos_monitor->geometry.height;
+        pmonitor++;
+    }
+
+    PackedIcon *picon = (PackedIcon *)pmonitor;
+    g_hash_table_iter_init(&iter, config->icon_positions);
+    XfdesktopIconPosition *position;
+    while (g_hash_table_iter_next(&iter, (gpointer)&id, (gpointer)&position)) {
+        picon->id = pack_string(strings, id);
+        picon->row = position->row;
+        picon->col = position->col;
+        picon->last_seen = position->last_seen;
+        picon++;
+    }
+
+    pconfig->strings_len = strings->len;
+    data = g_realloc(data, records_len + strings->len);
+    memcpy(data + records_len, strings->str, strings->len);
+    gsize len = records_len + strings->len;
+    g_string_free(strings, TRUE);
+
+    return g_bytes_new_take(data, len);
+}
+
+static guint32
+intern_cache_string(GHashTable *offsets, GString *strings, const gchar *pool, guint32 offset) {
+    if (offset == POSITION_CACHE_NO_STRING) {
+        return POSITION_CACHE_NO_STRING;
+    } else {
+        const gchar *str = pool + offset;
+        gpointer value = g_hash_table_lookup(offsets, str);
+        if (value != NULL) {
+            return GPOINTER_TO_UINT(value) - 1;
+        } else {
+            guint32 new_offset = strings->len;
+            g_string_append_len(strings, str, strlen(str) + 1);
+            g_hash_table_insert(offsets, (gpointer)str, GUINT_TO_POINTER(new_offset + 1));
+            return new_offset;
+        }
+    }
+}
+
+static gboolean
+get_yaml_stamp(const gchar *filename, guint64 *mtime, guint64 *size) {
+    GFile *file = g_file_new_for_path(filename);
+    GFileInfo *info = g_file_query_info(file,
+                                        G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                        G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+                                        G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                        G_FILE_QUERY_INFO_NONE,
+                                        NULL,
+                                        NULL);
+    g_object_unref(file);
+
+    if (info != NULL) {
+        *mtime = g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+            + g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+        *size = g_file_info_get_size(info);
+        g_object_unref(info);
+        return TRUE;
+    } else {
+        return FALSE;
+    }
+}
+
+// Safe to call from any thread.  Merges the string pools of every section's
+// packed record into one table, so an icon that has a position in many
+// configs only has its name stored once.
+static gboolean
+write_cache(SaveSnapshot *snapshot, guint64 yaml_mtime, guint64 yaml_size, GError **error) {
+    GHashTable *offsets = g_hash_table_new(g_str_hash, g_str_equal);
+    GString *strings = g_string_new(NULL);
+    GByteArray *data = g_byte_array_new();
+
+    for (guint i = 0; i < snapshot->sections->len; ++i) {
+        SnapshotSection *section = g_ptr_array_index(snapshot->sections, i);
+        const guint8 *packed = g_bytes_get_data(section->packed, NULL);
+        const PackedConfig *pconfig = (const PackedConfig *)packed;
+        const PackedMonitor *pmonitors = (const PackedMonitor *)(pconfig + 1);
+        const PackedIcon *picons = (const PackedIcon *)(pmonitors + pconfig->n_monitors);
+        const gchar *pool = (const gchar *)(picons + pconfig->n_icons);
+
+        PackedConfig out_config = *pconfig;
+        out_config.strings_len = 0;
+        g_byte_array_append(data, (const guint8 *)&out_config, sizeof(out_config));
+
+        for (guint32 j = 0; j < pconfig->n_monitors; ++j) {
+            PackedMonitor out_monitor = pmonitors[j];
+            out_monitor.id = intern_cache_string(offsets, strings, pool, out_monitor.id);
+            out_monitor.display_name = intern_cache_string(offsets, strings, pool, out_monitor.display_name);
+            g_byte_array_append(data, (const guint8 *)&out_monitor, sizeof(out_monitor));
+        }
+
+        for (guint32 j = 0; j < pconfig->n_icons; ++j) {
+            PackedIcon out_icon = picons[j];
+            out_icon.id = intern_cache_string(offsets, strings, pool, out_icon.id);
+            g_byte_array_append(data, (const guint8 *)&out_icon, sizeof(out_icon));
+        }
+    }
+
+    PositionCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, POSITION_CACHE_MAGIC, sizeof(header.magic));
+    header.version = POSITION_CACHE_VERSION;
+    header.byte_order = POSITION_CACHE_BYTE_ORDER;
+    header.yaml_mtime = yaml_mtime;
+    header.yaml_size = yaml_size;
+    header.data_len = data->len;
+    header.strings_len = strings->len;
+    header.n_configs = snapshot->sections->len;
+
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    g_checksum_update(checksum, data->data, data->len);
+    g_checksum_update(checksum, (const guchar *)strings->str, strings->len);
+    gsize digest_len = sizeof(header.checksum);
+    g_checksum_get_digest(checksum, header.checksum, &digest_len);
+    g_checksum_free(checksum);
+
+    gchar *cache_filename = g_strconcat(snapshot->filename, POSITION_CACHE_SUFFIX, NULL);
+    gchar *new_filename = g_strconcat(cache_filename, ".new", NULL);
+    gboolean success = FALSE;
+
+    FILE *output = fopen(new_filename, "wb");
+    if (output == NULL) {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    g_io_error_from_errno(errno),
+                    "Failed to open '%s' for writing: %s",
+                    new_filename,
+                    strerror(errno));
+    } else if (fwrite(&header, sizeof(header), 1, output) != 1
+               || fwrite(data->data, 1, data->len, output) != data->len
+               || fwrite(strings->str, 1, strings->len, output) != strings->len)
+    {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    g_io_error_from_errno(errno),
+                    "Failed to write to '%s': %s",
+                    new_filename,
+                    strerror(errno));
+        fclose(output);
+        unlink(new_filename);
+    } else if (fclose(output) != 0 || rename(new_filename, cache_filename) != 0) {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    g_io_error_from_errno(errno),
+                    "Failed to write '%s': %s",
+                    cache_filename,
+                    strerror(errno));
+        unlink(new_filename);
+    } else {
+        success = TRUE;
+    }
+
+    g_free(new_filename);
+    g_free(cache_filename);
+    g_byte_array_free(data, TRUE);
+    g_string_free(strings, TRUE);
+    g_hash_table_destroy(offsets);
+
+    return success;
+}
+
+static const gchar *
+cache_string(const gchar *strings, guint32 strings_len, guint32 offset) {
+    // The table is known to end in a NUL, so any offset inside it is a
+    // terminated string.
+    return offset < strings_len ? strings + offset : NULL;
+}
+
+// Returns NULL on success, or the reason the data was rejected.
+static const gchar *
+unpack_cache(const guint8 *data,
+             guint64 data_len,
+             const gchar *strings,
+             guint32 strings_len,
+             guint32 n_configs,
+             GList **configs_out)
+{
+    if (strings_len > 0 && strings[strings_len - 1] != '\0') {
+        return "unterminated string table";
+    }
+
+    guint64 pos = 0;
+    for (guint32 i = 0; i < n_configs; ++i) {
+        if (data_len - pos < sizeof(PackedConfig)) {
+            return "truncated config record";
+        }
+
+        const PackedConfig *pconfig = (const PackedConfig *)(data + pos);
+        pos += sizeof(PackedConfig);
+
+        if (pconfig->level < XFDESKTOP_ICON_POSITION_LEVEL_PRIMARY || pconfig->level > XFDESKTOP_ICON_POSITION_LEVEL_OTHER) {
+            return "invalid config level";
+        }
+
+        guint64 records_len = (guint64)pconfig->n_monitors * sizeof(PackedMonitor)
+            + (guint64)pconfig->n_icons * sizeof(PackedIcon);
+        if (data_len - pos < records_len) {
+            return "truncated monitor or icon records";
+        }
+
+        XfdesktopIconPositionConfig *config = xfdesktop_icon_position_config_new_internal(pconfig->level);
+        *configs_out = g_list_prepend(*configs_out, config);
+
+        const PackedMonitor *pmonitors = (const PackedMonitor *)(data + pos);
+        for (guint32 j = 0; j < pconfig->n_monitors; ++j) {
+            const gchar *id = cache_string(strings, strings_len, pmonitors[j].id);
+            const gchar *display_name = cache_string(strings, strings_len, pmonitors[j].display_name);
+            if (id == NULL || display_name == NULL) {
+                return "invalid monitor string";
+            }
+
+            XfdesktopIconPositionMonitor *pos_monitor = g_new0(XfdesktopIconPositionMonitor, 1);
+            pos_monitor->display_name = g_strdup(display_name);
+            pos_monitor->geometry.x = pmonitors[j].x;
+            pos_monitor->geometry.y = pmonitors[j].y;
+            pos_monitor->geometry.width = pmonitors[j].width;
+            pos_monitor->geometry.height = pmonitors[j].height;
+            g_hash_table_insert(config->monitors, g_strdup(id), pos_monitor);
+        }
+
+        const PackedIcon *picons = (const PackedIcon *)(pmonitors + pconfig->n_monitors);
+        for (guint32 j = 0; j < pconfig->n_icons; ++j) {
+            const gchar *id = cache_string(strings, strings_len, picons[j].id);
+            if (id == NULL) {
+                return "invalid icon string";
+            }
+
+            XfdesktopIconPosition *position = g_new0(XfdesktopIconPosition, 1);
+            position->row = picons[j].row;
+            position->col = picons[j].col;
+            position->last_seen = picons[j].last_seen;
+            g_hash_table_insert(config->icon_positions, g_strdup(id), position);
+        }
+
+        pos += records_len;
+    }
+
+    return pos == data_len ? NULL : "trailing data after config records";
+}
+
+static gboolean
+load_cache(XfdesktopIconPositionConfigs *configs, guint64 yaml_mtime, guint64 yaml_size) {
+    gint64 start = g_get_monotonic_time();
+
+    gchar *cache_filename = g_strconcat(g_file_peek_path(configs->file), POSITION_CACHE_SUFFIX, NULL);
+    GMappedFile *mapped = g_mapped_file_new(cache_filename, FALSE, NULL);
+    g_free(cache_filename);
+    if (mapped == NULL) {
+        return FALSE;
+    }
+
+    const gchar *contents = g_mapped_file_get_contents(mapped);
+    gsize len = g_mapped_file_get_length(mapped);
+    const PositionCacheHeader *header = (const PositionCacheHeader *)contents;
+    const gchar *reason = NULL;
+    GList *new_configs = NULL;
+
+    if (len < sizeof(PositionCacheHeader)) {
+        reason = "truncated header";
+    } else if (memcmp(header->magic, POSITION_CACHE_MAGIC, sizeof(header->magic)) != 0) {
+        reason = "bad magic";
+    } else if (header->version != POSITION_CACHE_VERSION || header->byte_order != POSITION_CACHE_BYTE_ORDER) {
+        reason = "unsupported version";
+    } else if (header->yaml_mtime != yaml_mtime || header->yaml_size != yaml_size) {
+        reason = "stale";
+    } else if (header->data_len > len - sizeof(PositionCacheHeader)
+               || header->strings_len != len - sizeof(PositionCacheHeader) - header->data_len)
+    {
+        reason = "bad length";
+    } else {
+        const guint8 *data = (const guint8 *)(header + 1);
+        const gchar *strings = (const gchar *)(data + header->data_len);
+
+        guint8 digest[sizeof(header->checksum)];
+        gsize digest_len = sizeof(digest);
+        GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+        g_checksum_update(checksum, data, header->data_len + header->strings_len);
+        g_checksum_get_digest(checksum, digest, &digest_len);
+        g_checksum_free(checksum);
+
+        if (memcmp(digest, header->checksum, sizeof(digest)) != 0) {
+            reason = "checksum mismatch";
+        } else {
+            reason = unpack_cache(data, header->data_len, strings, header->strings_len, header->n_configs, &new_configs);
+        }
+    }
+
+    g_mapped_file_unref(mapped);
+
+    if (reason != NULL) {
+        DBG("not using icon position cache: %s", reason);
+        g_list_free_full(new_configs, (GDestroyNotify)xfdesktop_icon_position_config_free);
+        return FALSE;
+    } else {
+        g_hash_table_remove_all(configs->config_to_monitor);
+        g_hash_table_remove_all(configs->icon_index);
+        g_list_free_full(configs->configs, (GDestroyNotify)xfdesktop_icon_position_config_free);
+
+        configs->configs = g_list_sort(new_configs, compare_configs_by_level);
+        for (GList *l = configs->configs; l != NULL; l = l->next) {
+            icon_index_add_config(configs, l->data);
+        }
+
+        DBG("loaded %u icon position configs from cache in %.3fms",
+            g_list_length(configs->configs),
+            (g_get_monotonic_time() - start) / 1000.0);
+        return TRUE;
+    }
+}
+
+static SaveWriter *
+save_writer_new(void) {
+    SaveWriter *writer = g_atomic_rc_box_new0(SaveWriter);
+    g_mutex_init(&writer->lock);
+    return writer;
+}
+
+static void
+save_writer_clear(SaveWriter *writer) {
+    g_mutex_clear(&writer->lock);
+}
+
+static void
+save_writer_unref(SaveWriter *writer) {
+    g_atomic_rc_box_release_full(writer, (GDestroyNotify)save_writer_clear);
+}
+
+static void
+snapshot_section_free(SnapshotSection *section) {
+    if (section->copy != NULL) {
+        xfdesktop_icon_position_config_free(section->copy);
+    }
+    if (section->serialized != NULL) {
+        g_bytes_unref(section->serialized);
+    }
+    if (section->packed != NULL) {
+        g_bytes_unref(section->packed);
+    }
+    g_free(section);
+}
+
+static void
+save_snapshot_free(SaveSnapshot *snapshot) {
+    save_writer_unref(snapshot->writer);
+    g_ptr_array_free(snapshot->sections, TRUE);
+    g_free(snapshot->filename);
+    g_free(snapshot);
+}
+
+// Runs on the main thread.  Clean configs just contribute a reference to
+// their cached YAML and cache record; dirty ones are copied so the worker
+// can serialize them without touching anything the main thread might be
+// changing.  When not writing the YAML, configs without a cache record are
+// packed right away instead, which is cheaper than copying them.
+static SaveSnapshot *
+save_snapshot_new(XfdesktopIconPositionConfigs *configs, gboolean write_yaml) {
+    SaveSnapshot *snapshot = g_new0(SaveSnapshot, 1);
+    snapshot->writer = g_atomic_rc_box_acquire(configs->writer);
+    snapshot->id = ++configs->last_snapshot_id;
+    snapshot->filename = g_file_get_path(configs->file);
+    snapshot->sections = g_ptr_array_new_full(g_list_length(configs->configs), (GDestroyNotify)snapshot_section_free);
+    snapshot->write_yaml = write_yaml;
+
+    for (GList *l = configs->configs; l != NULL; l = l->next) {
+        XfdesktopIconPositionConfig *config = l->data;
+        SnapshotSection *section = g_new0(SnapshotSection, 1);
+        section->config = config;
+        section->serial = config->serial;
+        if (write_yaml && config_is_dirty(config)) {
+            section->copy = config_copy_for_save(config);
+            snapshot->n_dirty++;
+        } else {
+            if (!config_is_dirty(config)) {
+                section->serialized = g_bytes_ref(config->serialized);
+            }
+
+            GBytes *packed = config_peek_packed(config);
+            section->packed = packed != NULL ? g_bytes_ref(packed) : pack_config(config);
+        }
+        g_ptr_array_add(snapshot->sections, section);
+    }
+
+    return snapshot;
+}
+
+static gboolean
+write_yaml_file(SaveSnapshot *snapshot, GError **error) {
+    gchar *new_filename = g_strconcat(snapshot->filename, ".new", NULL);
+    FILE *output = fopen(new_filename, "wb");
+    if (output == NULL) {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    g_io_error_from_errno(errno),
+                    "Failed to open '%s' for writing: %s",
+                    new_filename,
+                    strerror(errno));
+        g_free(new_filename);
+        return FALSE;
+    }
+
+    fputs("#\n# DO NOT EDIT THIS FILE WHILE XFDESKTOP IS RUNNING\n#\n", output);
+    fputs(snapshot->sections->len > 0 ? "configs:\n" : "configs: []\n", output);
+    for (guint i = 0; i < snapshot->sections->len; ++i) {
+        SnapshotSection *section = g_ptr_array_index(snapshot->sections, i);
+        gsize len;
+        gconstpointer data = g_bytes_get_data(section->serialized, &len);
+        if (fwrite(data, 1, len, output) != len) {
+            g_set_error(error,
+                        G_IO_ERROR,
+                        g_io_error_from_errno(errno),
+                        "Failed to write to '%s': %s",
+                        new_filename,
+                        strerror(errno));
+            goto out_err;
+        }
+    }
+
+    if (fflush(output) != 0 || fsync(fileno(output)) != 0) {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    g_io_error_from_errno(errno),
+                    "Failed to flush written file '%s': %s",
+                    new_filename,
+                    strerror(errno));
+        goto out_err;
+    }
+
     int ret = fclose(output);
     output = NULL;
 
@@ -475,13 +1177,19 @@ G_STMT_END
         goto out_err;
     }
 
-    if (rename(new_filename, g_file_peek_path(configs->file))) {
+    // Drop the old cache first, so that if writing the new one fails, we
+    // don't end up with a cache that happens to match the new file.
+    gchar *cache_filename = g_strconcat(snapshot->filename, POSITION_CACHE_SUFFIX, NULL);
+    unlink(cache_filename);
+    g_free(cache_filename);
+
+    if (rename(new_filename, snapshot->filename)) {
         g_set_error(error,
                     G_IO_ERROR,
                     g_io_error_from_errno(errno),
                     "Failed to rename '%s' to '%s': %s",
                     new_filename,
-                    g_file_peek_path(configs->file),
+                    snapshot->filename,
                     strerror(errno));
         goto out_err;
     }
@@ -491,7 +1199,6 @@ G_STMT_END
 
 out_err:
     if (output != NULL) {
-        yaml_emitter_delete(&emitter);
         fclose(output);
     }
     unlink(new_filename);
@@ -500,17 +1207,183 @@ out_err:
     return FALSE;
 }
 
+// Safe to call from any thread; only touches the snapshot.
 static gboolean
-save_icons_idled(gpointer data) {
-    XfdesktopIconPositionConfigs *configs = data;
-    configs->scheduled_save_id = 0;
+save_snapshot_write(SaveSnapshot *snapshot, GError **error) {
+    for (guint i = 0; i < snapshot->sections->len; ++i) {
+        SnapshotSection *section = g_ptr_array_index(snapshot->sections, i);
+        if (section->copy != NULL) {
+            if (snapshot->write_yaml && section->serialized == NULL) {
+                section->serialized = serialize_config(section->copy, error);
+                if (section->serialized == NULL) {
+                    return FALSE;
+                }
+            }
+            if (section->packed == NULL) {
+                section->packed = pack_config(section->copy);
+            }
+            g_clear_pointer(&section->copy, xfdesktop_icon_position_config_free);
+        }
+    }
+
+    g_mutex_lock(&snapshot->writer->lock);
+
+    if (snapshot->id < snapshot->writer->last_written_id) {
+        // A newer snapshot has already made it to disk.
+        g_mutex_unlock(&snapshot->writer->lock);
+        return TRUE;
+    }
+
+    if (snapshot->write_yaml) {
+        if (!write_yaml_file(snapshot, error)) {
+            g_mutex_unlock(&snapshot->writer->lock);
+            return FALSE;
+        }
+        snapshot->writer->last_written_id = snapshot->id;
+    }
 
+    // The cache is only an optimization, so failing to write it doesn't
+    // fail the save.
+    guint64 yaml_mtime, yaml_size;
+    if (get_yaml_stamp(snapshot->filename, &yaml_mtime, &yaml_size)
+        && (snapshot->write_yaml || (yaml_mtime == snapshot->yaml_mtime && yaml_size == snapshot->yaml_size)))
+    {
+        GError *cache_error = NULL;
+        if (!write_cache(snapshot, yaml_mtime, yaml_size, &cache_error)) {
+            g_message("Failed to write desktop icon position cache: %s", cache_error->message);
+            g_error_free(cache_error);
+        }
+    }
+
+    g_mutex_unlock(&snapshot->writer->lock);
+
+    return TRUE;
+}
+
+// Runs on the main thread once a snapshot has been written, to remember
+// the output for every config that hasn't changed again in the meantime.
+static void
+save_snapshot_apply_cache(XfdesktopIconPositionConfigs *configs, SaveSnapshot *snapshot) {
+    for (guint i = 0; i < snapshot->sections->len; ++i) {
+        SnapshotSection *section = g_ptr_array_index(snapshot->sections, i);
+        // Serials are unique across all configs, so a matching serial also
+        // means the config pointer still refers to the same, live config.
+        if (g_list_find(configs->configs, section->config) != NULL && section->config->serial == section->serial) {
+            XfdesktopIconPositionConfig *config = section->config;
+
+            if (config->cached_serial != section->serial) {
+                g_clear_pointer(&config->serialized, g_bytes_unref);
+                g_clear_pointer(&config->packed, g_bytes_unref);
+                config->cached_serial = section->serial;
+            }
+
+            if (section->serialized != NULL && config->serialized != section->serialized) {
+                if (config->serialized != NULL) {
+                    g_bytes_unref(config->serialized);
+                }
+                config->serialized = g_bytes_ref(section->serialized);
+            }
+
+            if (section->packed != NULL && config->packed != section->packed) {
+                if (config->packed != NULL) {
+                    g_bytes_unref(config->packed);
+                }
+                config->packed = g_bytes_ref(section->packed);
+            }
+        }
+    }
+}
+
+static gboolean
+save_icons(XfdesktopIconPositionConfigs *configs, GError **error) {
+    gint64 start = g_get_monotonic_time();
+    SaveSnapshot *snapshot = save_snapshot_new(configs, TRUE);
+    gboolean success = save_snapshot_write(snapshot, error);
+    if (success) {
+        save_snapshot_apply_cache(configs, snapshot);
+    }
+    DBG("saved %u configs (%u dirty) synchronously in %.3fms",
+        snapshot->sections->len,
+        snapshot->n_dirty,
+        (g_get_monotonic_time() - start) / 1000.0);
+    save_snapshot_free(snapshot);
+    return success;
+}
+
+static void
+save_icons_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    SaveSnapshot *snapshot = task_data;
+    gint64 start = g_get_monotonic_time();
+
+    // Cancellation only means our owner has gone away; it will have
+    // written a newer snapshot itself, so finishing here is harmless.
+    GError *error = NULL;
+    if (save_snapshot_write(snapshot, &error)) {
+        DBG("serialized %u of %u configs and wrote '%s' in %.3fms",
+            snapshot->n_dirty,
+            snapshot->sections->len,
+            snapshot->filename,
+            (g_get_monotonic_time() - start) / 1000.0);
+        g_task_return_boolean(task, TRUE);
+    } else {
+        g_task_return_error(task, error);
+    }
+}
+
+static void schedule_save(XfdesktopIconPositionConfigs *configs);
+
+static void
+save_icons_done(GObject *source_object, GAsyncResult *res, gpointer user_data) {
     GError *error = NULL;
-    if (!save_icons(configs, &error)) {
+    if (!g_task_propagate_boolean(G_TASK(res), &error)) {
+        if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            // configs has been freed already
+            g_error_free(error);
+            return;
+        }
+    }
+
+    XfdesktopIconPositionConfigs *configs = user_data;
+    configs->save_in_progress = FALSE;
+
+    if (error != NULL) {
         g_message("Failed to save desktop icon positions: %s", error->message);
         g_error_free(error);
+    } else {
+        save_snapshot_apply_cache(configs, g_task_get_task_data(G_TASK(res)));
+    }
+
+    if (configs->save_pending) {
+        configs->save_pending = FALSE;
+        schedule_save(configs);
+    }
+}
+
+static gboolean
+save_icons_idled(gpointer data) {
+    XfdesktopIconPositionConfigs *configs = data;
+    configs->scheduled_save_id = 0;
+
+    if (configs->save_in_progress) {
+        // Try again once the current write has finished.
+        configs->save_pending = TRUE;
+        return G_SOURCE_REMOVE;
     }
 
+    gint64 start = g_get_monotonic_time();
+    SaveSnapshot *snapshot = save_snapshot_new(configs, TRUE);
+    DBG("snapshotted %u configs (%u dirty) in %.3fms",
+        snapshot->sections->len,
+        snapshot->n_dirty,
+        (g_get_monotonic_time() - start) / 1000.0);
+
+    configs->save_in_progress = TRUE;
+    GTask *task = g_task_new(NULL, configs->cancellable, save_icons_done, configs);
+    g_task_set_source_tag(task, save_icons_idled);
+    g_task_set_task_data(task, snapshot, (GDestroyNotify)save_snapshot_free);
+    g_task_run_in_thread(task, save_icons_thread);
+    g_object_unref(task);
+
     return G_SOURCE_REMOVE;
 }
 
@@ -667,15 +1540,15 @@ xfdesktop_icon_position_configs_new(GFile *file) {
     XfdesktopIconPositionConfigs *configs = g_new0(XfdesktopIconPositionConfigs, 1);
     configs->file = g_object_ref(file);
     configs->config_to_monitor = g_hash_table_new(g_direct_hash, g_direct_equal);
+    configs->icon_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_array_unref);
+    configs->writer = save_writer_new();
+    configs->cancellable = g_cancellable_new();
 
     return configs;
 }
 
-gboolean
-xfdesktop_icon_position_configs_load(XfdesktopIconPositionConfigs *configs, GError **error) {
-    g_return_val_if_fail(configs != NULL, FALSE);
-    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
+static gboolean
+load_yaml(XfdesktopIconPositionConfigs *configs, GError **error) {
     yaml_parser_t parser;
     if (!yaml_parser_initialize(&parser)) {
         g_set_error(error,
@@ -702,6 +1575,7 @@ xfdesktop_icon_position_configs_load(XfdesktopIconPositionConfigs *configs, GErr
     yaml_parser_set_input_file(&parser, input);
 
     g_hash_table_remove_all(configs->config_to_monitor);
+    g_hash_table_remove_all(configs->icon_index);
     g_list_free_full(configs->configs, (GDestroyNotify)xfdesktop_icon_position_config_free);
     configs->configs = NULL;
 
@@ -1143,8 +2017,82 @@ xfdesktop_icon_position_configs_load(XfdesktopIconPositionConfigs *configs, GErr
         return FALSE;
     } else {
         configs->configs = g_list_sort(configs->configs, compare_configs_by_level);
+        for (GList *l = configs->configs; l != NULL; l = l->next) {
+            icon_index_add_config(configs, l->data);
+        }
+        return TRUE;
+    }
+}
+
+static void
+write_cache_done(GObject *source_object, GAsyncResult *res, gpointer user_data) {
+    GError *error = NULL;
+    if (!g_task_propagate_boolean(G_TASK(res), &error)
+        && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+        // configs has been freed already
+        g_error_free(error);
+        return;
+    }
+
+    XfdesktopIconPositionConfigs *configs = user_data;
+    if (error != NULL) {
+        g_message("Failed to write desktop icon position cache: %s", error->message);
+        g_error_free(error);
+    } else {
+        save_snapshot_apply_cache(configs, g_task_get_task_data(G_TASK(res)));
+    }
+}
+
+static void
+write_cache_in_background(XfdesktopIconPositionConfigs *configs, guint64 yaml_mtime, guint64 yaml_size) {
+    SaveSnapshot *snapshot = save_snapshot_new(configs, FALSE);
+    snapshot->yaml_mtime = yaml_mtime;
+    snapshot->yaml_size = yaml_size;
+
+    GTask *task = g_task_new(NULL, configs->cancellable, write_cache_done, configs);
+    g_task_set_source_tag(task, write_cache_in_background);
+    g_task_set_task_data(task, snapshot, (GDestroyNotify)save_snapshot_free);
+    g_task_run_in_thread(task, save_icons_thread);
+    g_object_unref(task);
+}
+
+gboolean
+xfdesktop_icon_position_configs_load(XfdesktopIconPositionConfigs *configs, GError **error) {
+    g_return_val_if_fail(configs != NULL, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    const gchar *filename = g_file_peek_path(configs->file);
+    guint64 yaml_mtime, yaml_size;
+    gboolean have_stamp = get_yaml_stamp(filename, &yaml_mtime, &yaml_size);
+
+    if (have_stamp && load_cache(configs, yaml_mtime, yaml_size)) {
+        XF_DEBUG("loaded %u icon position configs for '%s' from cache",
+                 g_list_length(configs->configs),
+                 filename);
         return TRUE;
     }
+
+    gint64 start = g_get_monotonic_time();
+    if (!load_yaml(configs, error)) {
+        return FALSE;
+    }
+    XF_DEBUG("loaded %u icon position configs for '%s' from YAML in %.3fms",
+             g_list_length(configs->configs),
+             filename,
+             (g_get_monotonic_time() - start) / 1000.0);
+
+    // Only cache what we parsed if the file didn't change underneath us.
+    guint64 new_yaml_mtime, new_yaml_size;
+    if (have_stamp
+        && get_yaml_stamp(filename, &new_yaml_mtime, &new_yaml_size)
+        && new_yaml_mtime == yaml_mtime
+        && new_yaml_size == yaml_size)
+    {
+        write_cache_in_background(configs, yaml_mtime, yaml_size);
+    }
+
+    return TRUE;
 }
 
 gboolean
@@ -1161,15 +2109,17 @@ xfdesktop_icon_position_configs_lookup(XfdesktopIconPositionConfigs *configs,
     XfwMonitor *best_monitor = NULL;
     XfdesktopIconPosition *best_position = NULL;
 
-    for (GList *l = configs->configs; l != NULL; l = l->next) {
-        XfdesktopIconPositionConfig *config = l->data;
-        XfwMonitor *config_monitor = g_hash_table_lookup(configs->config_to_monitor, config);
-        if (config_monitor != NULL) {
-            XfdesktopIconPosition *position = g_hash_table_lookup(config->icon_positions, icon_id);
-            if (position != NULL && config->level > best_level) {
-                best_level = config->level;
-                best_monitor = config_monitor;
-                best_position = position;
+    GArray *entries = g_hash_table_lookup(configs->icon_index, icon_id);
+    if (entries != NULL) {
+        for (guint i = 0; i < entries->len; ++i) {
+            IconIndexEntry *entry = &g_array_index(entries, IconIndexEntry, i);
+            if (entry->config->level > best_level) {
+                XfwMonitor *config_monitor = g_hash_table_lookup(configs->config_to_monitor, entry->config);
+                if (config_monitor != NULL) {
+                    best_level = entry->config->level;
+                    best_monitor = config_monitor;
+                    best_position = entry->position;
+                }
             }
         }
     }
@@ -1199,7 +2149,10 @@ xfdesktop_icon_position_configs_remove_icon(XfdesktopIconPositionConfigs *config
     g_return_if_fail(config != NULL);
     g_return_if_fail(icon_id != NULL);
 
-    if (g_hash_table_remove(config->icon_positions, icon_id)) {
+    if (g_hash_table_contains(config->icon_positions, icon_id)) {
+        icon_index_remove(configs, config, icon_id);
+        g_hash_table_remove(config->icon_positions, icon_id);
+        config_mark_dirty(config);
         schedule_save(configs);
     }
 }
@@ -1211,8 +2164,21 @@ xfdesktop_icon_position_configs_remove_icon_from_all(XfdesktopIconPositionConfig
     g_return_if_fail(configs != NULL);
     g_return_if_fail(icon_id != NULL);
 
-    for (GList *l = configs->configs; l != NULL; l = l->next) {
-        xfdesktop_icon_position_configs_remove_icon(configs, l->data, icon_id);
+    GArray *entries = g_hash_table_lookup(configs->icon_index, icon_id);
+    if (entries != NULL) {
+        // Removing the last entry frees the array, so steal it first.
+        gchar *key = NULL;
+        g_hash_table_steal_extended(configs->icon_index, icon_id, (gpointer)&key, NULL);
+
+        for (guint i = 0; i < entries->len; ++i) {
+            XfdesktopIconPositionConfig *config = g_array_index(entries, IconIndexEntry, i).config;
+            g_hash_table_remove(config->icon_positions, icon_id);
+            config_mark_dirty(config);
+        }
+
+        g_free(key);
+        g_array_unref(entries);
+        schedule_save(configs);
     }
 }
 
@@ -1237,17 +2203,33 @@ xfdesktop_icon_position_configs_set_icon_position(XfdesktopIconPositionConfigs *
     position->row = row;
     position->col = col;
     position->last_seen = last_seen_timestamp;
-
-    for (GList *l = configs->configs; l != NULL; l = l->next) {
-        XfdesktopIconPositionConfig *a_config = l->data;
-        if (a_config != config && a_config->level >= config->level) {
-            DBG("removing icon from higher or equal prio config");
-            // XXX: Do we want to do this for all configs, or only assigned
-            // configs?  I could make an argument either way.
-            g_hash_table_remove(a_config->icon_positions, identifier);
+    config_mark_dirty(config);
+
+    GArray *entries = g_hash_table_lookup(configs->icon_index, identifier);
+    if (entries != NULL) {
+        for (guint i = 0; i < entries->len;) {
+            XfdesktopIconPositionConfig *a_config = g_array_index(entries, IconIndexEntry, i).config;
+            if (a_config != config && a_config->level >= config->level) {
+                DBG("removing icon from higher or equal prio config");
+                // XXX: Do we want to do this for all configs, or only assigned
+                // configs?  I could make an argument either way.
+                g_hash_table_remove(a_config->icon_positions, identifier);
+                config_mark_dirty(a_config);
+                g_array_remove_index(entries, i);
+            } else {
+                ++i;
+            }
         }
     }
 
+    // Only configs in the list are indexed; anything else gets picked up
+    // when it's assigned to a monitor.
+    if (config->indexed) {
+        icon_index_add(configs, config, identifier, position);
+    } else if (entries != NULL && entries->len == 0) {
+        g_hash_table_remove(configs->icon_index, identifier);
+    }
+
     schedule_save(configs);
 }
 
@@ -1360,10 +2342,12 @@ xfdesktop_icon_position_configs_assign_monitor(XfdesktopIconPositionConfigs *con
         pos_monitor->display_name = g_strdup(xfw_monitor_get_description(monitor));
         xfw_monitor_get_logical_geometry(monitor, &pos_monitor->geometry);
         g_hash_table_insert(config->monitors, g_strdup(monitor_id), pos_monitor);
+        config_mark_dirty(config);
     }
 
     if (g_list_find(configs->configs, config) == NULL) {
         configs->configs = g_list_insert_sorted(configs->configs, config, compare_configs_by_level);
+        icon_index_add_config(configs, config);
     }
     g_hash_table_insert(configs->config_to_monitor, config, monitor);
 
@@ -1393,6 +2377,9 @@ xfdesktop_icon_position_configs_delete_config(XfdesktopIconPositionConfigs *conf
     g_return_if_fail(config != NULL);
 
     g_hash_table_remove(configs->config_to_monitor, config);
+    if (config->indexed) {
+        icon_index_remove_config(configs, config);
+    }
     configs->configs = g_list_remove(configs->configs, config);
 
     xfdesktop_icon_position_config_free(config);
@@ -1410,9 +2397,17 @@ xfdesktop_icon_position_configs_save(XfdesktopIconPositionConfigs *configs, GErr
 void
 xfdesktop_icon_position_configs_free(XfdesktopIconPositionConfigs *configs) {
     if (configs != NULL) {
-        if (configs->scheduled_save_id != 0) {
-            g_source_remove(configs->scheduled_save_id);
+        // Stops any in-flight save from calling back into us.
+        g_cancellable_cancel(configs->cancellable);
+
+        if (configs->scheduled_save_id != 0 || configs->save_in_progress) {
+            if (configs->scheduled_save_id != 0) {
+                g_source_remove(configs->scheduled_save_id);
+            }
 
+            // A save still running on the worker may have missed changes made
+            // after its snapshot was taken, and might not finish before we
+            // exit, so write out the current state now.
             GError *error = NULL;
             if (!save_icons(configs, &error)) {
                 g_message("Failed to save desktop icon positions: %s", error->message);
@@ -1421,7 +2416,10 @@ xfdesktop_icon_position_configs_free(XfdesktopIconPositionConfigs *configs) {
         }
 
         g_hash_table_destroy(configs->config_to_monitor);
+        g_hash_table_destroy(configs->icon_index);
         g_list_free_full(configs->configs, (GDestroyNotify)xfdesktop_icon_position_config_free);
+        g_object_unref(configs->cancellable);
+        save_writer_unref(configs->writer);
         g_object_unref(configs->file);
         g_free(configs);
     }
@@ -1450,6 +2448,7 @@ _xfdesktop_icon_position_config_set_icon_position(XfdesktopIconPositionConfig *c
 
     position->row = row;
     position->col = col;
+    config_mark_dirty(config);
 }
 
 GList *  // caller owned container, callee owned data
@@ -1470,6 +2469,12 @@ xfdesktop_icon_position_config_free(XfdesktopIconPositionConfig *config) {
     if (config != NULL) {
         g_hash_table_destroy(config->icon_positions);
         g_hash_table_destroy(config->monitors);
+        if (config->serialized != NULL) {
+            g_bytes_unref(config->serialized);
+        }
+        if (config->packed != NULL) {
+            g_bytes_unref(config->packed);
+        }
         g_free(config);
     }
 }
@@ -46,6 +46,7 @@
 #include "xfdesktop-common.h"
 #include "xfdesktop-icon-view.h"
 #include "xfdesktop-marshal.h"
+#include "xfdesktop-startup-trace.h"
 
 #define ICON_SIZE         (icon_view->icon_size)
 #define TEXT_WIDTH        ((icon_view->cell_text_width_proportion) * ICON_SIZE)
@@ -89,6 +90,7 @@ enum
     SIG_ICON_SELECTION_CHANGED = 0,
     SIG_ICON_ACTIVATED,
     SIG_ICON_MOVED,
+    SIG_ICONS_MOVED,
     SIG_QUERY_ICON_TOOLTIP,
     SIG_START_GRID_RESIZE,
     SIG_END_GRID_RESIZE,
@@ -151,6 +153,14 @@ typedef struct
     cairo_region_t *icon_slot_region;
 
     cairo_surface_t *pixbuf_surface;
+    // From the opacity column, read along with the surface; applied when
+    // painting, so the surface itself is always opaque.
+    gdouble opacity;
+
+    // Filename collation key of the label, and the sort priority, as of
+    // the last sort; NULL until then, or after the row changes.
+    gchar *sort_key;
+    gint sort_priority;
 
     guint32 has_iter:1;
     guint32 selected:1;
@@ -173,6 +183,7 @@ view_item_new(GtkTreeModel *model, GtkTreeIter *iter)
     item->col = -1;
     item->has_iter = (gtk_tree_model_get_flags(model) & GTK_TREE_MODEL_ITERS_PERSIST) != 0;
     item->sensitive = TRUE;
+    item->opacity = 1.0;
     item->icon_slot_region = cairo_region_create();
 
     if (item->has_iter) {
@@ -237,6 +248,7 @@ view_item_free(ViewItem *item)
     if (item->pixbuf_surface != NULL) {
         cairo_surface_destroy(item->pixbuf_surface);
     }
+    g_free(item->sort_key);
     if (!item->has_iter && item->ref.row_ref != NULL) {
         gtk_tree_row_reference_free(item->ref.row_ref);
     }
@@ -248,54 +260,38 @@ view_item_free(ViewItem *item)
 typedef struct
 {
     ViewItem *item;
-    gchar *label;
+    // Owned by the item.
+    const gchar *key;
+    gint priority;
 } SortItem;
 
-static SortItem *
-sort_item_new(ViewItem *item)
-{
-    SortItem *sort_item;
-
-    g_return_val_if_fail(item != NULL, NULL);
-
-    sort_item = g_slice_new0(SortItem);
-    sort_item->item = item;
-
-    return sort_item;
-}
+typedef struct {
+    // Search label, lowercased a character at a time, the same way typed
+    // characters are.
+    gchar *key;
+    // Position in ->items when the index was built; earlier items win when
+    // several match.
+    guint position;
+    ViewItem *item;
+} LabelIndexEntry;
 
 static gint
-sort_item_compare(SortItem *a,
-                  SortItem *b,
+sort_item_compare(gconstpointer a,
+                  gconstpointer b,
                   gpointer user_data)
 {
+    const SortItem *sa = a;
+    const SortItem *sb = b;
     GtkSortType sort_type = GPOINTER_TO_INT(user_data);
-    gchar *al, *bl;
 
-    al = a->label != NULL ? a->label : "";
-    bl = b->label != NULL ? b->label : "";
+    // FIXME: should GtkSortType also affect the order of the priority buckets?
+    if (sa->priority != sb->priority) {
+        return sa->priority < sb->priority ? -1 : 1;
+    }
 
     return sort_type == GTK_SORT_ASCENDING
-        ? g_utf8_collate(al, bl)
-        : g_utf8_collate(bl, al);
-}
-
-static void
-sort_item_free(SortItem *sort_item)
-{
-    g_return_if_fail(sort_item != NULL);
-
-    g_free(sort_item->label);
-    g_slice_free(SortItem, sort_item);
-}
-
-static gint
-int_compare(gconstpointer a,
-            gconstpointer b)
-{
-    gint ia = GPOINTER_TO_INT(a);
-    gint ib = GPOINTER_TO_INT(b);
-    return ia - ib;
+        ? strcmp(sa->key, sb->key)
+        : strcmp(sb->key, sa->key);
 }
 
 struct _XfdesktopIconView {
@@ -340,6 +336,24 @@ struct _XfdesktopIconView {
     gint nrows;
     gint ncols;
     ViewItem **grid_layout;
+    // How far (in pixels) below its own slot an item's label can reach
+    // (selected items show their full label).  Grows as item extents are
+    // calculated, and is recomputed when the grid or icon size changes.
+    gint slot_overflow;
+
+    // Number of icon images loaded so far; themed icons may come out of
+    // GTK's own cache, but thumbnails are decoded every time.
+    guint n_icon_decodes;
+
+    // Only set while a drop is being applied: redraws are collected into
+    // pending_redraw, and rows changed by the icons-moved handlers into
+    // moved_items, so both can be dealt with once at the end.  A handler
+    // can spin the main loop and let another drop in, so these are shared
+    // until the outermost drop is done.
+    cairo_region_t *pending_redraw;
+    GHashTable *moved_items;  // ViewItem set
+    guint moves_depth;
+    gboolean applying_moves;
 
     GtkSelectionMode sel_mode;
     guint maybe_begin_drag:1,
@@ -360,6 +374,8 @@ struct _XfdesktopIconView {
     /* element-type gunichar */
     GArray *keyboard_navigation_state;
     guint keyboard_navigation_state_timeout;
+    // LabelIndexEntry, sorted by key; built on first use
+    GArray *label_index;
 
     gboolean draw_focus;
     ViewItem *cursor;
@@ -501,6 +517,8 @@ static gboolean xfdesktop_icon_view_place_item_at(XfdesktopIconView *icon_view,
                                                   ViewItem *item,
                                                   gint row,
                                                   gint col);
+static void xfdesktop_icon_view_begin_moves(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_end_moves(XfdesktopIconView *icon_view);
 static void xfdesktop_icon_view_unplace_item(XfdesktopIconView *icon_view,
                                              ViewItem *item);
 static void xfdesktop_icon_view_update_item_extents(XfdesktopIconView *icon_view,
@@ -515,6 +533,8 @@ static void xfdesktop_icon_view_invalidate_item_text(XfdesktopIconView *icon_vie
                                                      ViewItem *item);
 
 static void xfdesktop_icon_view_invalidate_pixbuf_cache(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_invalidate_sort_keys(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_invalidate_label_index(XfdesktopIconView *icon_view);
 
 static gboolean xfdesktop_icon_view_select_item_internal(XfdesktopIconView *icon_view,
                                                          ViewItem *item,
@@ -675,7 +695,7 @@ xfdesktop_icon_view_class_init(XfdesktopIconViewClass *klass)
      * @dest_row: the new row on @icon_view.
      * @dest_col: the new row on @icon_view.
      *
-     * Emitted when @icon_view has recieved icons from @source_icon_view.
+     * Emitted when @icon_view has received icons from @source_icon_view.
      * @source_iter refers to the icon with respect to @source_icon_view's
      * model.  (@dest_row, @dest_col) is the new location on @icon_view.
      **/
@@ -691,6 +711,28 @@ xfdesktop_icon_view_class_init(XfdesktopIconViewClass *klass)
                                              G_TYPE_INT,
                                              G_TYPE_INT);
 
+    /**
+     * XfdesktopIconView::icons-moved:
+     * @icon_view: the destination #XfdesktopIconView.
+     * @source_icon_view: the source #XfdesktopIconView.
+     * @moves: (element-type XfdesktopIconMove): the moved icons.
+     *
+     * Emitted once when @icon_view has received a set of dragged icons from
+     * @source_icon_view.  Each #XfdesktopIconMove's @source_iter refers to
+     * the icon with respect to @source_icon_view's model.  Handlers should
+     * only change the icons' positions; the view applies all of the
+     * resulting row changes together after the last handler has run.
+     **/
+    __signals[SIG_ICONS_MOVED] = g_signal_new("icons-moved",
+                                              XFDESKTOP_TYPE_ICON_VIEW,
+                                              G_SIGNAL_RUN_LAST,
+                                              0,
+                                              NULL, NULL,
+                                              xfdesktop_marshal_VOID__OBJECT_POINTER,
+                                              G_TYPE_NONE, 2,
+                                              XFDESKTOP_TYPE_ICON_VIEW,
+                                              G_TYPE_POINTER);
+
     __signals[SIG_QUERY_ICON_TOOLTIP] = g_signal_new("query-icon-tooltip",
                                                      XFDESKTOP_TYPE_ICON_VIEW,
                                                      G_SIGNAL_RUN_LAST,
@@ -1383,6 +1425,15 @@ xfdesktop_icon_view_invalidate_all(XfdesktopIconView *icon_view,
     }
 }
 
+static void
+xfdesktop_icon_view_invalidate_sort_keys(XfdesktopIconView *icon_view)
+{
+    for (GList *l = icon_view->items; l != NULL; l = l->next) {
+        ViewItem *item = (ViewItem *)l->data;
+        g_clear_pointer(&item->sort_key, g_free);
+    }
+}
+
 static void
 xfdesktop_icon_view_invalidate_pixbuf_cache(XfdesktopIconView *icon_view)
 {
@@ -1778,6 +1829,109 @@ keyboard_navigation_timeout(gpointer data) {
     return G_SOURCE_REMOVE;
 }
 
+static void
+label_index_entry_clear(gpointer data) {
+    LabelIndexEntry *entry = data;
+    g_free(entry->key);
+}
+
+static gint
+label_index_entry_compare(gconstpointer a, gconstpointer b) {
+    return strcmp(((const LabelIndexEntry *)a)->key, ((const LabelIndexEntry *)b)->key);
+}
+
+static gchar *
+label_index_key(const gchar *label) {
+    if (!g_utf8_validate(label, -1, NULL)) {
+        return NULL;
+    }
+
+    GString *key = g_string_sized_new(strlen(label));
+    for (const gchar *p = label; *p != '\0'; p = g_utf8_next_char(p)) {
+        g_string_append_unichar(key, g_unichar_tolower(g_utf8_get_char(p)));
+    }
+    return g_string_free(key, FALSE);
+}
+
+static void
+xfdesktop_icon_view_build_label_index(XfdesktopIconView *icon_view) {
+    icon_view->label_index = g_array_sized_new(FALSE, FALSE, sizeof(LabelIndexEntry), g_list_length(icon_view->items));
+    g_array_set_clear_func(icon_view->label_index, label_index_entry_clear);
+
+    guint position = 0;
+    for (GList *l = icon_view->items; l != NULL; l = l->next, ++position) {
+        ViewItem *item = l->data;
+        GtkTreeIter iter;
+        gchar *label = NULL;
+
+        if (view_item_get_iter(item, icon_view->model, &iter)) {
+            gtk_tree_model_get(icon_view->model, &iter,
+                               icon_view->search_column, &label,
+                               -1);
+        }
+
+        if (label != NULL) {
+            LabelIndexEntry entry = {
+                .key = label_index_key(label),
+                .position = position,
+                .item = item,
+            };
+            if (entry.key != NULL) {
+                g_array_append_val(icon_view->label_index, entry);
+            }
+            g_free(label);
+        }
+    }
+
+    g_array_sort(icon_view->label_index, label_index_entry_compare);
+}
+
+static void
+xfdesktop_icon_view_invalidate_label_index(XfdesktopIconView *icon_view) {
+    if (icon_view->label_index != NULL) {
+        g_array_free(icon_view->label_index, TRUE);
+        icon_view->label_index = NULL;
+    }
+}
+
+static ViewItem *
+xfdesktop_icon_view_find_label_prefix(XfdesktopIconView *icon_view, const gchar *prefix) {
+    if (icon_view->label_index == NULL) {
+        xfdesktop_icon_view_build_label_index(icon_view);
+    }
+
+    GArray *index = icon_view->label_index;
+    gsize prefix_len = strlen(prefix);
+
+    // Find the first key that isn't less than the prefix; every key
+    // starting with the prefix follows it.
+    guint lo = 0;
+    guint hi = index->len;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (strcmp(g_array_index(index, LabelIndexEntry, mid).key, prefix) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    ViewItem *match = NULL;
+    guint match_position = G_MAXUINT;
+    for (guint i = lo; i < index->len; ++i) {
+        LabelIndexEntry *entry = &g_array_index(index, LabelIndexEntry, i);
+        if (strncmp(entry->key, prefix, prefix_len) != 0) {
+            break;
+        }
+        if (entry->item->placed && entry->position < match_position) {
+            match = entry->item;
+            match_position = entry->position;
+        }
+    }
+
+    return match;
+}
+
 static gboolean
 xfdesktop_icon_view_keyboard_navigate(XfdesktopIconView *icon_view,
                                       gunichar lower_char)
@@ -1804,49 +1958,20 @@ xfdesktop_icon_view_keyboard_navigate(XfdesktopIconView *icon_view,
 
     g_array_append_val(icon_view->keyboard_navigation_state, lower_char);
 
-    for (GList *l = icon_view->items; l != NULL && !found_match; l = l->next) {
-        ViewItem *item = l->data;
-
-        if (item->placed) {
-            GtkTreeIter iter;
-            gchar *label = NULL;
-            if (view_item_get_iter(item, icon_view->model, &iter)) {
-                gtk_tree_model_get(icon_view->model, &iter,
-                                   icon_view->search_column, &label,
-                                   -1);
-            }
-
-            if (label != NULL && g_utf8_validate(label, -1, NULL)) {
-                gchar *p = label;
-                gboolean matches = TRUE;
-
-                for (guint i = 0; i < icon_view->keyboard_navigation_state->len; ++i) {
-                    gunichar label_char;
-
-                    if (*p == '\0') {
-                        matches = FALSE;
-                        break;
-                    }
-
-                    label_char = g_unichar_tolower(g_utf8_get_char(p));
-                    if (label_char != g_array_index(icon_view->keyboard_navigation_state, gunichar, i)) {
-                        matches = FALSE;
-                        break;
-                    }
-
-                    p = g_utf8_find_next_char(p, NULL);
-                }
-
-                if (matches) {
-                    xfdesktop_icon_view_unselect_all(icon_view);
-                    xfdesktop_icon_view_set_cursor(icon_view, item, TRUE);
-                    xfdesktop_icon_view_select_item_internal(icon_view, item, TRUE);
-                    found_match = TRUE;
-                }
-            }
-
-            g_free(label);
+    gchar *prefix = g_ucs4_to_utf8((gunichar *)(gpointer)icon_view->keyboard_navigation_state->data,
+                                   icon_view->keyboard_navigation_state->len,
+                                   NULL,
+                                   NULL,
+                                   NULL);
+    if (prefix != NULL) {
+        ViewItem *item = xfdesktop_icon_view_find_label_prefix(icon_view, prefix);
+        if (item != NULL) {
+            xfdesktop_icon_view_unselect_all(icon_view);
+            xfdesktop_icon_view_set_cursor(icon_view, item, TRUE);
+            xfdesktop_icon_view_select_item_internal(icon_view, item, TRUE);
+            found_match = TRUE;
         }
+        g_free(prefix);
     }
 
     return found_match;
@@ -2054,6 +2179,196 @@ xfdesktop_icon_view_xfconf_tooltip_icon_size_changed(XfconfChannel *channel,
     icon_view->tooltip_icon_size_xfconf = g_value_get_double(value);
 }
 
+// Labels can hang down into the rows below their own slot, so items a few
+// rows up may reach into a given rectangle too.
+static inline gint
+xfdesktop_icon_view_overflow_rows(XfdesktopIconView *icon_view) {
+    return (gint)ceil(icon_view->slot_overflow / (SLOT_SIZE + icon_view->yspacing));
+}
+
+static gboolean
+xfdesktop_icon_view_rect_to_slot_range(XfdesktopIconView *icon_view,
+                                       const GdkRectangle *rect,
+                                       gint *first_row,
+                                       gint *last_row,
+                                       gint *first_col,
+                                       gint *last_col)
+{
+    // SLOT_SIZE isn't a whole number of pixels, so do this the same way
+    // xfdesktop_icon_view_widget_coords_to_slot_coords() does, or the range
+    // drifts a pixel per slot away from where the slots are drawn.
+    gdouble row_stride = SLOT_SIZE + icon_view->yspacing;
+    gdouble col_stride = SLOT_SIZE + icon_view->xspacing;
+    gint x0 = rect->x - icon_view->xmargin;
+    gint y0 = rect->y - icon_view->ymargin;
+    gint x1 = x0 + rect->width - 1;
+    gint y1 = y0 + rect->height - 1;
+
+    if (x1 < 0 || y1 < 0 || icon_view->nrows <= 0 || icon_view->ncols <= 0) {
+        return FALSE;
+    }
+
+    gint overflow_rows = xfdesktop_icon_view_overflow_rows(icon_view);
+
+    *first_col = (gint)(MAX(x0, 0) / col_stride);
+    *last_col = MIN((gint)(x1 / col_stride), icon_view->ncols - 1);
+    *first_row = MAX((gint)(MAX(y0, 0) / row_stride) - overflow_rows, 0);
+    *last_row = MIN((gint)(y1 / row_stride), icon_view->nrows - 1);
+
+    return *first_col <= *last_col && *first_row <= *last_row;
+}
+
+static inline gboolean
+xfdesktop_icon_view_slot_inside_rect(XfdesktopIconView *icon_view, gint row, gint col, const GdkRectangle *rect) {
+    gint x = icon_view->xmargin + col * (SLOT_SIZE + icon_view->xspacing);
+    gint y = icon_view->ymargin + row * (SLOT_SIZE + icon_view->yspacing);
+    gint height = SLOT_SIZE + icon_view->slot_overflow;
+    return x >= rect->x
+        && y >= rect->y
+        && x + SLOT_SIZE <= rect->x + rect->width
+        && y + height <= rect->y + rect->height;
+}
+
+// Brings the selection state of the items in one block of slots up to date
+// with the band having moved from @old_rect to @new_rect.  Empty blocks are
+// fine.
+static void
+xfdesktop_icon_view_update_band_slots(XfdesktopIconView *icon_view,
+                                      const GdkRectangle *old_rect,
+                                      const GdkRectangle *new_rect,
+                                      gint first_row,
+                                      gint last_row,
+                                      gint first_col,
+                                      gint last_col)
+{
+    for (gint col = first_col; col <= last_col; ++col) {
+        for (gint row = first_row; row <= last_row; ++row) {
+            ViewItem *item = xfdesktop_icon_view_item_in_slot(icon_view, row, col);
+            if (item == NULL) {
+                continue;
+            }
+
+            // Well inside both bands means it was selected when it entered
+            // the band, and it hasn't left.
+            if (xfdesktop_icon_view_slot_inside_rect(icon_view, row, col, old_rect)
+                && xfdesktop_icon_view_slot_inside_rect(icon_view, row, col, new_rect))
+            {
+                continue;
+            }
+
+            gboolean in_new = cairo_region_contains_rectangle(item->icon_slot_region, new_rect) != CAIRO_REGION_OVERLAP_OUT;
+            if (in_new) {
+                /* since _select_item() prepends to the list, we
+                 * should be ok just calling this */
+                xfdesktop_icon_view_select_item_internal(icon_view, item, TRUE);
+            } else if (item->selected
+                       && cairo_region_contains_rectangle(item->icon_slot_region, old_rect) != CAIRO_REGION_OVERLAP_OUT)
+            {
+                /* To be removed, it must intersect the old rectangle and
+                 * not intersect the new one. This way CTRL + rubber band
+                 * works properly (Bug 10275) */
+                xfdesktop_icon_view_unselect_item_internal(icon_view, item, TRUE);
+            }
+        }
+    }
+}
+
+static void
+xfdesktop_icon_view_update_band_selection(XfdesktopIconView *icon_view,
+                                          const GdkRectangle *old_rect,
+                                          const GdkRectangle *new_rect)
+{
+    if (G_UNLIKELY(icon_view->grid_layout == NULL)) {
+        return;
+    }
+
+    gint old_first_row, old_last_row, old_first_col, old_last_col;
+    gint new_first_row, new_last_row, new_first_col, new_last_col;
+    gboolean have_old = xfdesktop_icon_view_rect_to_slot_range(icon_view,
+                                                               old_rect,
+                                                               &old_first_row,
+                                                               &old_last_row,
+                                                               &old_first_col,
+                                                               &old_last_col);
+    gboolean have_new = xfdesktop_icon_view_rect_to_slot_range(icon_view,
+                                                               new_rect,
+                                                               &new_first_row,
+                                                               &new_last_row,
+                                                               &new_first_col,
+                                                               &new_last_col);
+    if (!have_old && !have_new) {
+        return;
+    } else if (!have_old) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              new_first_row, new_last_row, new_first_col, new_last_col);
+        return;
+    } else if (!have_new) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              old_first_row, old_last_row, old_first_col, old_last_col);
+        return;
+    }
+
+    gint first_row = MIN(old_first_row, new_first_row);
+    gint last_row = MAX(old_last_row, new_last_row);
+    gint first_col = MIN(old_first_col, new_first_col);
+    gint last_col = MAX(old_last_col, new_last_col);
+    gint shared_first_row = MAX(old_first_row, new_first_row);
+    gint shared_last_row = MIN(old_last_row, new_last_row);
+    gint shared_first_col = MAX(old_first_col, new_first_col);
+    gint shared_last_col = MIN(old_last_col, new_last_col);
+
+    if (shared_first_col > shared_last_col) {
+        // The band jumped clear of where it was; there's nothing to share.
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              old_first_row, old_last_row, old_first_col, old_last_col);
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              new_first_row, new_last_row, new_first_col, new_last_col);
+        return;
+    }
+
+    // Only the strips covered by one band but not the other can have
+    // entered or left it: first the columns under only one of them...
+    xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                          first_row, last_row, first_col, shared_first_col - 1);
+    xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                          first_row, last_row, shared_last_col + 1, last_col);
+
+    // ...then, within the shared columns, the rows under only one.
+    if (shared_first_row > shared_last_row) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              first_row, last_row, shared_first_col, shared_last_col);
+        return;
+    }
+    xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                          first_row, shared_first_row - 1, shared_first_col, shared_last_col);
+    xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                          shared_last_row + 1, last_row, shared_first_col, shared_last_col);
+
+    // An edge can also move without leaving the slots it was in, and still
+    // cross an icon or label there.  Slots are only partly covered along an
+    // edge, or within reach of a label hanging over it, so only edges that
+    // moved need their own strip looked at again.
+    gint edge_rows = xfdesktop_icon_view_overflow_rows(icon_view) + 1;
+    if (old_rect->x != new_rect->x) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              shared_first_row, shared_last_row, shared_first_col, shared_first_col);
+    }
+    if (old_rect->x + old_rect->width != new_rect->x + new_rect->width) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              shared_first_row, shared_last_row, shared_last_col, shared_last_col);
+    }
+    if (old_rect->y != new_rect->y) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              shared_first_row, MIN(shared_first_row + edge_rows, shared_last_row),
+                                              shared_first_col, shared_last_col);
+    }
+    if (old_rect->y + old_rect->height != new_rect->y + new_rect->height) {
+        xfdesktop_icon_view_update_band_slots(icon_view, old_rect, new_rect,
+                                              MAX(shared_last_row - edge_rows, shared_first_row), shared_last_row,
+                                              shared_first_col, shared_last_col);
+    }
+}
+
 static gboolean
 xfdesktop_icon_view_motion_notify(GtkWidget *widget, GdkEventMotion *evt) {
     XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
@@ -2121,47 +2436,7 @@ xfdesktop_icon_view_motion_notify(GtkWidget *widget, GdkEventMotion *evt) {
         gdk_window_invalidate_region(gtk_widget_get_window(widget), region, TRUE);
 
         /* update list of selected icons */
-
-        /* first pass: if the rubber band area got smaller at least in
-         * one dimension, we can try first to just remove icons that
-         * aren't in the band anymore */
-        if (old_rect.width > new_rect->width || old_rect.height > new_rect->height) {
-            GList *l = icon_view->selected_items;
-            while(l) {
-                ViewItem *item = l->data;
-
-                /* To be removed, it must intersect the old rectangle and
-                 * not intersect the new one. This way CTRL + rubber band
-                 * works properly (Bug 10275) */
-
-                if (cairo_region_contains_rectangle(item->icon_slot_region, &old_rect) != CAIRO_REGION_OVERLAP_OUT
-                    && cairo_region_contains_rectangle(item->icon_slot_region, new_rect) == CAIRO_REGION_OVERLAP_OUT)
-                {
-                    /* remove the icon from the selected list */
-                    l = l->next;
-                    xfdesktop_icon_view_unselect_item_internal(icon_view, item, TRUE);
-                } else {
-                    l = l->next;
-                }
-            }
-        }
-
-        /* second pass: if at least one dimension got larger, unfortunately
-         * we have to figure out what icons to add to the selected list */
-        if (old_rect.width < new_rect->width || old_rect.height < new_rect->height) {
-            for (GList *l = icon_view->items; l != NULL; l = l->next) {
-                ViewItem *item = l->data;
-
-                if (!item->selected
-                    && item->placed
-                    && cairo_region_contains_rectangle(item->icon_slot_region, new_rect) != CAIRO_REGION_OVERLAP_OUT)
-                {
-                    /* since _select_item() prepends to the list, we
-                     * should be ok just calling this */
-                    xfdesktop_icon_view_select_item_internal(icon_view, item, TRUE);
-                }
-            }
-        }
+        xfdesktop_icon_view_update_band_selection(icon_view, &old_rect, new_rect);
 
         cairo_region_destroy(region);
     } else {
@@ -2194,6 +2469,40 @@ xfdesktop_icon_view_leave_notify(GtkWidget *widget, GdkEventCrossing *evt) {
     return FALSE;
 }
 
+// Returns the size to load a GFileIcon at so the image fits in an
+// ICON_WIDTH x ICON_SIZE box, or -1 if the image's dimensions can't be read
+// without decoding it.
+static gint
+xfdesktop_icon_view_thumbnail_load_size(XfdesktopIconView *icon_view,
+                                        GIcon *icon)
+{
+    GIcon *file_icon = G_IS_EMBLEMED_ICON(icon) ? g_emblemed_icon_get_icon(G_EMBLEMED_ICON(icon)) : icon;
+    const gchar *path = g_file_peek_path(g_file_icon_get_file(G_FILE_ICON(file_icon)));
+    gint width = 0, height = 0;
+
+    if (path == NULL || gdk_pixbuf_get_file_info(path, &width, &height) == NULL || width <= 0 || height <= 0) {
+        return -1;
+    }
+
+    // GTK scales the image so its longest side matches the requested size.
+    // Landscape images can use the full icon width, as long as that doesn't
+    // make them taller than the icon size.
+    if (width > height) {
+        return MAX(1, (gint)MIN(ICON_WIDTH, (gdouble)ICON_SIZE * width / height));
+    } else {
+        return MAX(1, (gint)MIN(ICON_WIDTH, ICON_SIZE));
+    }
+}
+
+static GdkPixbuf *
+xfdesktop_icon_view_load_icon(XfdesktopIconView *icon_view,
+                              GtkIconInfo *icon_info,
+                              GtkStyleContext *context)
+{
+    icon_view->n_icon_decodes++;
+    return gtk_icon_info_load_symbolic_for_context(icon_info, context, NULL, NULL);
+}
+
 static cairo_surface_t *
 xfdesktop_icon_view_get_surface_for_item(XfdesktopIconView *icon_view,
                                          ViewItem *item)
@@ -2224,35 +2533,27 @@ xfdesktop_icon_view_get_surface_for_item(XfdesktopIconView *icon_view,
                     if (G_IS_FILE_ICON(icon) || (G_IS_EMBLEMED_ICON(icon) && G_IS_FILE_ICON(g_emblemed_icon_get_icon(G_EMBLEMED_ICON(icon))))) {
                         // Special case for GFileIcon, which will usually be a thumbnail.  We
                         // allow thumbnails to be wider than the icon size that's set, as long
-                        // as the height is no taller than the icon size.
+                        // as the height is no taller than the icon size.  Reading the image
+                        // header first lets us pick a size that fits, so the image only has
+                        // to be decoded once.
+                        gint load_size = xfdesktop_icon_view_thumbnail_load_size(icon_view, icon);
                         GtkIconInfo *icon_info = gtk_icon_theme_lookup_by_gicon_for_scale(icon_theme,
                                                                                           icon,
-                                                                                          ICON_WIDTH,
+                                                                                          load_size > 0 ? load_size : ICON_WIDTH,
                                                                                           scale_factor,
                                                                                           GTK_ICON_LOOKUP_FORCE_SIZE);
                         if (G_LIKELY(icon_info != NULL)) {
-                            pix = gtk_icon_info_load_symbolic_for_context(icon_info, context, NULL, NULL);
-                            if (G_LIKELY(pix != NULL)) {
-                                gint width = gdk_pixbuf_get_width(pix);
-                                gint height = gdk_pixbuf_get_height(pix);
-
-                                if (height > ICON_SIZE * scale_factor) {
-                                    if (height < width) {
-                                        // The height is less than the width, so it's probably
-                                        // worth using the larger icon.
-                                        GdkPixbuf *scaled = xfce_gdk_pixbuf_scale_down(pix,
-                                                                                       TRUE,
-                                                                                       ICON_WIDTH * scale_factor,
-                                                                                       ICON_SIZE * scale_factor);
-                                        g_object_unref(pix);
-                                        pix = scaled;
-                                    } else {
-                                        // The height is of equal size to the width, so we
-                                        // should try to load the icon at the correct size.
-                                        g_object_unref(pix);
-                                        pix = NULL;
-                                    }
-                                }
+                            pix = xfdesktop_icon_view_load_icon(icon_view, icon_info, context);
+                            if (G_LIKELY(pix != NULL) && gdk_pixbuf_get_height(pix) > ICON_SIZE * scale_factor) {
+                                // We couldn't read the header (or the image wasn't what it
+                                // claimed to be), so shrink what we got rather than decoding
+                                // it a second time.
+                                GdkPixbuf *scaled = xfce_gdk_pixbuf_scale_down(pix,
+                                                                               TRUE,
+                                                                               ICON_WIDTH * scale_factor,
+                                                                               ICON_SIZE * scale_factor);
+                                g_object_unref(pix);
+                                pix = scaled;
                             }
                             g_object_unref(icon_info);
                         }
@@ -2267,23 +2568,18 @@ xfdesktop_icon_view_get_surface_for_item(XfdesktopIconView *icon_view,
                                                                                           scale_factor,
                                                                                           GTK_ICON_LOOKUP_FORCE_SIZE);
                         if (G_LIKELY(icon_info != NULL)) {
-                            pix = gtk_icon_info_load_symbolic_for_context(icon_info, context, NULL, NULL);
+                            pix = xfdesktop_icon_view_load_icon(icon_view, icon_info, context);
                             g_object_unref(icon_info);
                         }
                     }
 
                     if (G_LIKELY(pix != NULL)) {
+                        item->opacity = 1.0;
                         if (icon_view->icon_opacity_column != -1) {
-                            gdouble opacity = 1.0;
                             gtk_tree_model_get(icon_view->model, &iter,
-                                               icon_view->icon_opacity_column, &opacity,
+                                               icon_view->icon_opacity_column, &item->opacity,
                                                -1);
-                            opacity = CLAMP(opacity, 0.0, 1.0);
-                            if (opacity < 1.0) {
-                                GdkPixbuf *tmp = xfce_gdk_pixbuf_lucent(pix, opacity * 100);
-                                g_object_unref(pix);
-                                pix = tmp;
-                            }
+                            item->opacity = CLAMP(item->opacity, 0.0, 1.0);
                         }
 
                         surface = gdk_cairo_surface_create_from_pixbuf(pix,
@@ -2498,6 +2794,69 @@ xfdesktop_icon_view_drag_drop(GtkWidget *widget,
     }
 }
 
+static void
+xfdesktop_icon_view_begin_moves(XfdesktopIconView *icon_view)
+{
+    if (icon_view->moves_depth++ == 0) {
+        icon_view->pending_redraw = cairo_region_create();
+        icon_view->moved_items = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+}
+
+static void
+xfdesktop_icon_view_end_moves(XfdesktopIconView *icon_view)
+{
+    g_return_if_fail(icon_view->moves_depth > 0);
+
+    if (--icon_view->moves_depth > 0) {
+        return;
+    }
+
+    GHashTable *moved_items = g_steal_pointer(&icon_view->moved_items);
+    GPtrArray *to_place = g_ptr_array_sized_new(g_hash_table_size(moved_items));
+
+    // Take every moved icon out of the grid before putting any of them back,
+    // so icons moving into each other's old slots don't collide.
+    GHashTableIter iter;
+    ViewItem *item;
+    g_hash_table_iter_init(&iter, moved_items);
+    while (g_hash_table_iter_next(&iter, (gpointer)&item, NULL)) {
+        if (item->placed && icon_view->row_column != -1 && icon_view->col_column != -1) {
+            GtkTreeIter model_iter;
+            gint row = -1, col = -1;
+
+            if (view_item_get_iter(item, icon_view->model, &model_iter)) {
+                gtk_tree_model_get(icon_view->model, &model_iter,
+                                   icon_view->row_column, &row,
+                                   icon_view->col_column, &col,
+                                   -1);
+            }
+
+            if (row == item->row && col == item->col) {
+                continue;
+            }
+
+            xfdesktop_icon_view_unplace_item(icon_view, item);
+        }
+
+        if (!item->placed) {
+            g_ptr_array_add(to_place, item);
+        }
+    }
+    g_hash_table_destroy(moved_items);
+
+    for (guint i = 0; i < to_place->len; ++i) {
+        xfdesktop_icon_view_place_item(icon_view, g_ptr_array_index(to_place, i), TRUE);
+    }
+    g_ptr_array_free(to_place, TRUE);
+
+    cairo_region_t *pending_redraw = g_steal_pointer(&icon_view->pending_redraw);
+    if (!cairo_region_is_empty(pending_redraw)) {
+        gtk_widget_queue_draw_region(GTK_WIDGET(icon_view), pending_redraw);
+    }
+    cairo_region_destroy(pending_redraw);
+}
+
 static void
 xfdesktop_icon_view_drag_data_received(GtkWidget *widget,
                                        GdkDragContext *context,
@@ -2544,12 +2903,16 @@ xfdesktop_icon_view_drag_data_received(GtkWidget *widget,
             }
             DBG("move offset: (%d, %d)", row_offset, col_offset);
 
+            xfdesktop_icon_view_begin_moves(icon_view);
+
             if (icon_list->source_icon_view == icon_view) {
                 // We're moving in the same icon view, so unplace the dropped
                 // icons so we can find new places for them without conflicts.
                 for (GList *l = icon_list->dragged_icons; l != NULL; l = l->next) {
                     XfdesktopDraggedIcon *dragged_icon = l->data;
                     xfdesktop_icon_view_unplace_item(icon_list->source_icon_view, dragged_icon->item);
+                    // Even if nobody changes its row, it needs placing again.
+                    g_hash_table_add(icon_view->moved_items, dragged_icon->item);
                 }
             }
 
@@ -2608,15 +2971,25 @@ xfdesktop_icon_view_drag_data_received(GtkWidget *widget,
             g_list_free(unplaceable);
             g_free(temp_grid_layout);
 
+            GArray *moves = g_array_sized_new(FALSE, FALSE, sizeof(XfdesktopIconMove), g_list_length(icon_list->dragged_icons));
             for (GList *l = icon_list->dragged_icons; l != NULL; l = l->next) {
                 XfdesktopDraggedIcon *dragged_icon = l->data;
-                g_signal_emit(icon_view, __signals[SIG_ICON_MOVED], 0,
-                              icon_list->source_icon_view,
-                              &dragged_icon->iter,
-                              dragged_icon->dest_row,
-                              dragged_icon->dest_col);
+                XfdesktopIconMove move = {
+                    .source_iter = dragged_icon->iter,
+                    .dest_row = dragged_icon->dest_row,
+                    .dest_col = dragged_icon->dest_col,
+                };
+                g_array_append_val(moves, move);
             }
 
+            gboolean was_applying_moves = icon_view->applying_moves;
+            icon_view->applying_moves = TRUE;
+            g_signal_emit(icon_view, __signals[SIG_ICONS_MOVED], 0, icon_list->source_icon_view, moves);
+            icon_view->applying_moves = was_applying_moves;
+            g_array_free(moves, TRUE);
+
+            xfdesktop_icon_view_end_moves(icon_view);
+
             icon_view->drag_dropped = FALSE;
             gtk_drag_finish(context, TRUE, FALSE, time_);
         } else if (icon_view->drag_dropped) {
@@ -2632,13 +3005,10 @@ void
 xfdesktop_icon_view_sort_icons(XfdesktopIconView *icon_view,
                                GtkSortType sort_type)
 {
-    GHashTable *priority_buckets;
-    GList *sorted_buckets;
-
     g_return_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view));
     g_return_if_fail(icon_view->model != NULL);
 
-    priority_buckets = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GArray *sort_items = g_array_sized_new(FALSE, FALSE, sizeof(SortItem), g_list_length(icon_view->items));
 
     for (GList *l = icon_view->items; l != NULL; l = l->next) {
         ViewItem *item = (ViewItem *)l->data;
@@ -2651,51 +3021,46 @@ xfdesktop_icon_view_sort_icons(XfdesktopIconView *icon_view,
         item->col = -1;
 
         if (view_item_get_iter(item, icon_view->model, &iter)) {
-            SortItem *sort_item;
-            gint priority = 0;
-            GList *sort_items;
-
-            sort_item = sort_item_new(item);
+            if (item->sort_key == NULL) {
+                gchar *label = NULL;
+
+                if (icon_view->sort_priority_column != -1) {
+                    gtk_tree_model_get(icon_view->model, &iter,
+                                       icon_view->text_column, &label,
+                                       icon_view->sort_priority_column, &item->sort_priority,
+                                       -1);
+                } else {
+                    gtk_tree_model_get(icon_view->model, &iter,
+                                       icon_view->text_column, &label,
+                                       -1);
+                    item->sort_priority = 0;
+                }
 
-            if (icon_view->sort_priority_column != -1) {
-                gtk_tree_model_get(icon_view->model, &iter,
-                                   icon_view->text_column, &sort_item->label,
-                                   icon_view->sort_priority_column, &priority,
-                                   -1);
-            } else {
-                gtk_tree_model_get(icon_view->model, &iter,
-                                   icon_view->text_column, &sort_item->label,
-                                   -1);
-                priority = 0;
+                item->sort_key = g_utf8_collate_key_for_filename(label != NULL ? label : "", -1);
+                g_free(label);
             }
 
-            sort_items = g_hash_table_lookup(priority_buckets, GINT_TO_POINTER(priority));
-            sort_items = g_list_insert_sorted_with_data(sort_items, sort_item, (GCompareDataFunc)sort_item_compare, GINT_TO_POINTER(sort_type));
-            g_hash_table_replace(priority_buckets, GINT_TO_POINTER(priority), sort_items);
+            SortItem sort_item = {
+                .item = item,
+                .key = item->sort_key,
+                .priority = item->sort_priority,
+            };
+            g_array_append_val(sort_items, sort_item);
         }
     }
 
-    sorted_buckets = g_hash_table_get_keys(priority_buckets);
-    // FIXME: should GtkSortType also affect the order of the priority buckets?
-    sorted_buckets = g_list_sort(sorted_buckets, int_compare);
+    // Priority first, then label; the sort is stable, so items with equal
+    // labels keep their model order.
+    g_array_sort_with_data(sort_items, sort_item_compare, GINT_TO_POINTER(sort_type));
 
     xfdesktop_icon_view_clear_grid_layout(icon_view);
 
-    for (GList *sbl = sorted_buckets; sbl != NULL; sbl = sbl->next) {
-        GList *sort_items = g_hash_table_lookup(priority_buckets, sbl->data);
-
-        for (GList *l = sort_items; l != NULL; l = l->next) {
-            SortItem *sort_item = (SortItem *)l->data;
-
-            xfdesktop_icon_view_place_item(icon_view, sort_item->item, FALSE);
-            sort_item_free(sort_item);
-        }
-
-        g_list_free(sort_items);
+    for (guint i = 0; i < sort_items->len; ++i) {
+        SortItem *sort_item = &g_array_index(sort_items, SortItem, i);
+        xfdesktop_icon_view_place_item(icon_view, sort_item->item, FALSE);
     }
-    g_list_free(sorted_buckets);
 
-    g_hash_table_destroy(priority_buckets);
+    g_array_free(sort_items, TRUE);
 }
 
 static void
@@ -3044,6 +3409,26 @@ xfdesktop_icon_view_unset_cell_properties(XfdesktopIconView *icon_view)
                  NULL);
 }
 
+static inline void
+xfdesktop_icon_view_note_slot_overflow(XfdesktopIconView *icon_view, ViewItem *item) {
+    // The label is the bottom-most part of the item, and its extents are
+    // relative to the slot, so this doesn't depend on where the slot is.
+    if (item->text_extents.height > 0) {
+        gint overflow = (gint)ceil(item->text_extents.y + item->text_extents.height - SLOT_SIZE);
+        icon_view->slot_overflow = MAX(icon_view->slot_overflow, overflow);
+    }
+}
+
+// Items' extents can shrink along with the slots, so start over from what
+// they are now.
+static void
+xfdesktop_icon_view_reset_slot_overflow(XfdesktopIconView *icon_view) {
+    icon_view->slot_overflow = 0;
+    for (GList *l = icon_view->items; l != NULL; l = l->next) {
+        xfdesktop_icon_view_note_slot_overflow(icon_view, l->data);
+    }
+}
+
 static void
 xfdesktop_icon_view_update_item_extents(XfdesktopIconView *icon_view,
                                         ViewItem *item)
@@ -3087,6 +3472,8 @@ xfdesktop_icon_view_update_item_extents(XfdesktopIconView *icon_view,
     xfdesktop_icon_view_shift_to_slot_area(icon_view, item, &item->text_extents, &slot_part_extents);
     cairo_region_union_rectangle(item->icon_slot_region, &slot_part_extents);
 
+    xfdesktop_icon_view_note_slot_overflow(icon_view, item);
+
 #if 0
     DBG("new icon extents: %dx%d+%d+%d", item->icon_extents.width, item->icon_extents.height, item->icon_extents.x, item->icon_extents.y);
     DBG("new text extents: %dx%d+%d+%d", item->text_extents.width, item->text_extents.height, item->text_extents.x, item->text_extents.y);
@@ -3096,77 +3483,152 @@ xfdesktop_icon_view_update_item_extents(XfdesktopIconView *icon_view,
 #endif
 }
 
+#define STATE_VARIANT_FLAGS (GTK_CELL_RENDERER_SELECTED | GTK_CELL_RENDERER_PRELIT | GTK_CELL_RENDERER_INSENSITIVE)
+#define N_STATE_VARIANTS 8
+
+typedef struct {
+    cairo_surface_t *surface;
+    // The style colors the variant was tinted with.
+    GdkRGBA insensitive_color;
+    GdkRGBA selected_color;
+} StateVariant;
+
+// Attached to an item's base icon surface, so the tinted variants go away
+// along with it when the icon changes, or the icon theme or scale does.
+typedef struct {
+    StateVariant variants[N_STATE_VARIANTS];
+} StateVariantCache;
+
+static cairo_user_data_key_t state_variant_cache_key;
+
+static void
+state_variant_cache_free(gpointer data) {
+    StateVariantCache *cache = data;
+    for (gint i = 0; i < N_STATE_VARIANTS; ++i) {
+        if (cache->variants[i].surface != NULL) {
+            cairo_surface_destroy(cache->variants[i].surface);
+        }
+    }
+    g_free(cache);
+}
+
+static inline gint
+state_variant_index(GtkCellRendererState flags) {
+    return ((flags & GTK_CELL_RENDERER_SELECTED) != 0 ? 1 : 0)
+        | ((flags & GTK_CELL_RENDERER_PRELIT) != 0 ? 2 : 0)
+        | ((flags & GTK_CELL_RENDERER_INSENSITIVE) != 0 ? 4 : 0);
+}
+
+static cairo_surface_t *
+create_icon_surface_for_state(cairo_surface_t *orig_surface,
+                              GtkCellRendererState flags,
+                              const GdkRGBA *insensitive_color,
+                              const GdkRGBA *selected_color)
+{
+    static cairo_user_data_key_t data_mem_key;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    unsigned char *data;
+    int height, stride;
+    double xoff, yoff;
+    double xscale, yscale;
+
+    height = cairo_image_surface_get_height(orig_surface);
+    stride = cairo_image_surface_get_stride(orig_surface);
+    data = g_malloc(stride * height);
+    cairo_surface_flush(orig_surface);
+    memcpy(data, cairo_image_surface_get_data(orig_surface), stride * height);
+
+    surface = cairo_image_surface_create_for_data(
+        data,
+        cairo_image_surface_get_format(orig_surface),
+        cairo_image_surface_get_width(orig_surface),
+        height,
+        stride
+    );
+    cairo_surface_set_user_data(surface, &data_mem_key, data, g_free);
+    cairo_surface_get_device_offset(orig_surface, &xoff, &yoff);
+    cairo_surface_get_device_scale(orig_surface, &xscale, &yscale);
+    cairo_surface_set_device_offset(surface, xoff, yoff);
+    cairo_surface_set_device_scale(surface, xscale, yscale);
+
+    cr = cairo_create(surface);
+
+    if ((flags & GTK_CELL_RENDERER_INSENSITIVE) != 0) {
+        cairo_set_operator(cr, CAIRO_OPERATOR_MULTIPLY);
+        gdk_cairo_set_source_rgba(cr, insensitive_color);
+        cairo_mask_surface(cr, surface, 0, 0);
+    }
+
+    if ((flags & GTK_CELL_RENDERER_SELECTED) != 0) {
+        cairo_set_operator(cr, CAIRO_OPERATOR_ATOP);
+        cairo_set_source_rgba(cr, selected_color->red, selected_color->green, selected_color->blue, 0.4);
+        cairo_paint(cr);
+    }
+
+    if ((flags & GTK_CELL_RENDERER_PRELIT) != 0) {
+        cairo_set_operator(cr, CAIRO_OPERATOR_COLOR_DODGE);
+        cairo_set_source_rgb(cr, 0.2, 0.2, 0.2);
+        cairo_mask_surface(cr, surface, 0, 0);
+    }
+
+    cairo_destroy(cr);
+
+    return surface;
+}
+
 static void
 update_icon_surface_for_state(GtkCellRenderer *cell,
                               GtkStyleContext *style_context,
                               GtkCellRendererState flags)
 {
-    if (((flags & (GTK_CELL_RENDERER_SELECTED | GTK_CELL_RENDERER_PRELIT | GTK_CELL_RENDERER_INSENSITIVE)) != 0)) {
+    if ((flags & STATE_VARIANT_FLAGS) != 0) {
         cairo_surface_t *orig_surface = NULL;
 
         g_object_get(cell,
                      "surface", &orig_surface,
                      NULL);
         if (orig_surface != NULL && cairo_surface_get_type(orig_surface) == CAIRO_SURFACE_TYPE_IMAGE) {
-            static cairo_user_data_key_t data_mem_key;
-            cairo_surface_t *surface;
-            cairo_t *cr;
-            unsigned char *data;
-            int height, stride;
-            double xoff, yoff;
-            double xscale, yscale;
-
-            height = cairo_image_surface_get_height(orig_surface);
-            stride = cairo_image_surface_get_stride(orig_surface);
-            data = g_malloc(stride * height);
-            memcpy(data, cairo_image_surface_get_data(orig_surface), stride * height);
-
-            surface = cairo_image_surface_create_for_data(
-                data,
-                cairo_image_surface_get_format(orig_surface),
-                cairo_image_surface_get_width(orig_surface),
-                height,
-                stride
-            );
-            cairo_surface_set_user_data(surface, &data_mem_key, data, g_free);
-            cairo_surface_get_device_offset(orig_surface, &xoff, &yoff);
-            cairo_surface_get_device_scale(orig_surface, &xscale, &yscale);
-            cairo_surface_set_device_offset(surface, xoff, yoff);
-            cairo_surface_set_device_scale(surface, xscale, yscale);
-            cairo_surface_destroy(orig_surface);
-
-            cr = cairo_create(surface);
+            GdkRGBA insensitive_color = { 0, };
+            GdkRGBA selected_color = { 0, };
 
             if ((flags & GTK_CELL_RENDERER_INSENSITIVE) != 0) {
-                GdkRGBA color;
-
-                gtk_style_context_get_color(style_context, GTK_STATE_FLAG_INSENSITIVE, &color);
-                cairo_set_operator(cr, CAIRO_OPERATOR_MULTIPLY);
-                gdk_cairo_set_source_rgba(cr, &color);
-                cairo_mask_surface(cr, surface, 0, 0);
+                gtk_style_context_get_color(style_context, GTK_STATE_FLAG_INSENSITIVE, &insensitive_color);
             }
-
             if ((flags & GTK_CELL_RENDERER_SELECTED) != 0) {
-                GdkRGBA color;
-
-                gtk_style_context_get_color(style_context, GTK_STATE_FLAG_ACTIVE, &color);
-                cairo_set_operator(cr, CAIRO_OPERATOR_ATOP);
-                cairo_set_source_rgba(cr, color.red, color.green, color.blue, 0.4);
-                cairo_paint(cr);
+                gtk_style_context_get_color(style_context, GTK_STATE_FLAG_ACTIVE, &selected_color);
             }
 
-            if ((flags & GTK_CELL_RENDERER_PRELIT) != 0) {
-                cairo_set_operator(cr, CAIRO_OPERATOR_COLOR_DODGE);
-                cairo_set_source_rgb(cr, 0.2, 0.2, 0.2);
-                cairo_mask_surface(cr, surface, 0, 0);
+            StateVariantCache *cache = cairo_surface_get_user_data(orig_surface, &state_variant_cache_key);
+            if (cache == NULL) {
+                cache = g_new0(StateVariantCache, 1);
+                cairo_surface_set_user_data(orig_surface, &state_variant_cache_key, cache, state_variant_cache_free);
             }
 
-            cairo_destroy(cr);
+            // Keying on the colors takes care of style and theme changes.
+            StateVariant *variant = &cache->variants[state_variant_index(flags)];
+            if (variant->surface == NULL
+                || !gdk_rgba_equal(&variant->insensitive_color, &insensitive_color)
+                || !gdk_rgba_equal(&variant->selected_color, &selected_color))
+            {
+                if (variant->surface != NULL) {
+                    cairo_surface_destroy(variant->surface);
+                }
+                variant->surface = create_icon_surface_for_state(orig_surface,
+                                                                 flags,
+                                                                 &insensitive_color,
+                                                                 &selected_color);
+                variant->insensitive_color = insensitive_color;
+                variant->selected_color = selected_color;
+            }
 
             g_object_set(cell,
-                         "surface", surface,
+                         "surface", variant->surface,
                          NULL);
-            cairo_surface_destroy(surface);
+        }
+
+        if (orig_surface != NULL) {
+            cairo_surface_destroy(orig_surface);
         }
     }
 }
@@ -3212,12 +3674,25 @@ xfdesktop_icon_view_draw_item_cell(XfdesktopIconView *icon_view,
     DBG("paint cell for (%d,%d) at %dx%d+%d+%d", item->row, item->col, cell_area.width, cell_area.height, cell_area.x, cell_area.y);
 #endif
 
-    gtk_cell_renderer_render(renderer,
-                             cr,
-                             GTK_WIDGET(icon_view),
-                             &cell_area,
-                             &cell_area,
-                             flags);
+    if (renderer == icon_view->icon_renderer && item->opacity < 1.0) {
+        // Only as big as the clip, which is at most the icon's cell.
+        cairo_push_group(cr);
+        gtk_cell_renderer_render(renderer,
+                                 cr,
+                                 GTK_WIDGET(icon_view),
+                                 &cell_area,
+                                 &cell_area,
+                                 flags);
+        cairo_pop_group_to_source(cr);
+        cairo_paint_with_alpha(cr, item->opacity);
+    } else {
+        gtk_cell_renderer_render(renderer,
+                                 cr,
+                                 GTK_WIDGET(icon_view),
+                                 &cell_area,
+                                 &cell_area,
+                                 flags);
+    }
 
 #if 0
     cairo_set_source_rgb(cr, 1.0, 0.0, 0.0);
@@ -3319,6 +3794,8 @@ xfdesktop_icon_view_draw(GtkWidget *widget,
     gdk_cairo_get_clip_rectangle(cr, &clipbox);
     TRACE("clipbox is %dx%d+%d+%d", clipbox.width, clipbox.height, clipbox.x, clipbox.y);
 
+    guint n_decodes_before = icon_view->n_icon_decodes;
+
     for (GList *l = icon_view->items; l != NULL; l = l->next) {
         ViewItem *item = l->data;
         if (item->placed && !item->selected) {
@@ -3334,6 +3811,14 @@ xfdesktop_icon_view_draw(GtkWidget *widget,
 
     xfdesktop_icon_view_unset_cell_properties(icon_view);
 
+    if (icon_view->n_icon_decodes != n_decodes_before) {
+        DBG("loaded %u icon images while drawing", icon_view->n_icon_decodes - n_decodes_before);
+    }
+
+    if (icon_view->items != NULL) {
+        xfdesktop_startup_trace_mark("first-icon-paint");
+    }
+
     if (icon_view->definitely_rubber_banding) {
         GdkRectangle intersect;
 
@@ -3762,6 +4247,7 @@ xfdesktop_icon_view_size_grid(XfdesktopIconView *icon_view)
     icon_view->ymargin = new_grid_params.ymargin;
     icon_view->xspacing = new_grid_params.xspacing;
     icon_view->yspacing = new_grid_params.yspacing;
+    xfdesktop_icon_view_reset_slot_overflow(icon_view);
 
     if (icon_view->grid_layout == NULL) {
         icon_view->grid_layout = g_malloc0(new_size);
@@ -3799,11 +4285,16 @@ xfdesktop_icon_view_queue_draw_item(XfdesktopIconView *icon_view,
             .height = SLOT_SIZE,
         };
         xfdesktop_icon_view_shift_to_slot_area(icon_view, item, &slot_rect, &slot_rect);
-        cairo_region_t *draw_region = cairo_region_create_rectangle(&slot_rect);
-        cairo_region_union(draw_region, item->icon_slot_region);
+        if (icon_view->pending_redraw != NULL) {
+            cairo_region_union_rectangle(icon_view->pending_redraw, &slot_rect);
+            cairo_region_union(icon_view->pending_redraw, item->icon_slot_region);
+        } else {
+            cairo_region_t *draw_region = cairo_region_create_rectangle(&slot_rect);
+            cairo_region_union(draw_region, item->icon_slot_region);
 
-        gtk_widget_queue_draw_region(GTK_WIDGET(icon_view), draw_region);
-        cairo_region_destroy(draw_region);
+            gtk_widget_queue_draw_region(GTK_WIDGET(icon_view), draw_region);
+            cairo_region_destroy(draw_region);
+        }
 
         return TRUE;
     } else {
@@ -4113,6 +4604,7 @@ xfdesktop_icon_view_model_row_inserted(GtkTreeModel *model,
     DBG("entering, index=%d", gtk_tree_path_get_indices(path)[0]);
 
     icon_view->items = g_list_insert(icon_view->items, item, idx);
+    xfdesktop_icon_view_invalidate_label_index(icon_view);
 
     if (xfdesktop_icon_view_place_item(icon_view, item, TRUE)) {
         DBG("placed new icon at (%d, %d)", item->row, item->col);
@@ -4129,11 +4621,18 @@ xfdesktop_icon_view_model_row_changed(GtkTreeModel *model,
 {
     ViewItem *item = g_list_nth_data(icon_view->items, gtk_tree_path_get_indices(path)[0]);
 
-    if (item != NULL) {
+    if (item != NULL && icon_view->applying_moves) {
+        // Only the position changed; xfdesktop_icon_view_end_moves() will
+        // take care of it.
+        g_hash_table_add(icon_view->moved_items, item);
+    } else if (item != NULL) {
         if (item->pixbuf_surface != NULL) {
             cairo_surface_destroy(item->pixbuf_surface);
             item->pixbuf_surface = NULL;
         }
+        // The label may have changed.
+        xfdesktop_icon_view_invalidate_label_index(icon_view);
+        g_clear_pointer(&item->sort_key, g_free);
         xfdesktop_icon_view_invalidate_item(icon_view, item, TRUE);
 
         if (item->placed && icon_view->row_column != -1 && icon_view->col_column != -1) {
@@ -4164,8 +4663,12 @@ xfdesktop_icon_view_model_row_deleted(GtkTreeModel *model,
         if (item->placed) {
             xfdesktop_icon_view_unplace_item(icon_view, item);
         }
+        if (icon_view->moved_items != NULL) {
+            g_hash_table_remove(icon_view->moved_items, item);
+        }
 
         icon_view->items = g_list_delete_link(icon_view->items, item_l);
+        xfdesktop_icon_view_invalidate_label_index(icon_view);
 
         view_item_free(item);
     }
@@ -4192,6 +4695,12 @@ xfdesktop_icon_view_items_free(XfdesktopIconView *icon_view)
     g_list_free(icon_view->selected_items);
     icon_view->selected_items = NULL;
 
+    xfdesktop_icon_view_invalidate_label_index(icon_view);
+
+    if (icon_view->moved_items != NULL) {
+        g_hash_table_remove_all(icon_view->moved_items);
+    }
+
     g_list_free_full(icon_view->items, (GDestroyNotify)view_item_free);
     icon_view->items = NULL;
 }
@@ -4351,6 +4860,8 @@ xfdesktop_icon_view_set_icon_opacity_column(XfdesktopIconView *icon_view, gint c
 
     changed = xfdesktop_icon_view_set_column(icon_view, column, &icon_view->icon_opacity_column, G_TYPE_DOUBLE, "icon-opacity-column");
     if (changed) {
+        // Opacity is read along with the surface.
+        xfdesktop_icon_view_invalidate_pixbuf_cache(icon_view);
         xfdesktop_icon_view_invalidate_all(icon_view, TRUE);
     }
 
@@ -4368,6 +4879,7 @@ xfdesktop_icon_view_set_text_column(XfdesktopIconView *icon_view,
 
     changed = xfdesktop_icon_view_set_column(icon_view, column, &icon_view->text_column, G_TYPE_STRING, "text-column");
     if (changed) {
+        xfdesktop_icon_view_invalidate_sort_keys(icon_view);
         xfdesktop_icon_view_invalidate_all(icon_view, TRUE);
     }
 
@@ -4378,14 +4890,18 @@ void
 xfdesktop_icon_view_set_search_column(XfdesktopIconView *icon_view,
                                       gint column)
 {
-    xfdesktop_icon_view_set_column(icon_view, column, &icon_view->search_column, G_TYPE_STRING, "search-column");
+    if (xfdesktop_icon_view_set_column(icon_view, column, &icon_view->search_column, G_TYPE_STRING, "search-column")) {
+        xfdesktop_icon_view_invalidate_label_index(icon_view);
+    }
 }
 
 void
 xfdesktop_icon_view_set_sort_priority_column(XfdesktopIconView *icon_view,
                                              gint column)
 {
-    xfdesktop_icon_view_set_column(icon_view, column, &icon_view->sort_priority_column, G_TYPE_INT, "sort-priority-column");
+    if (xfdesktop_icon_view_set_column(icon_view, column, &icon_view->sort_priority_column, G_TYPE_INT, "sort-priority-column")) {
+        xfdesktop_icon_view_invalidate_sort_keys(icon_view);
+    }
 }
 
 void
@@ -4850,6 +5366,7 @@ xfdesktop_icon_view_set_icon_size(XfdesktopIconView *icon_view,
     icon_view->icon_size = icon_size;
 
     xfdesktop_icon_view_invalidate_pixbuf_cache(icon_view);
+    xfdesktop_icon_view_reset_slot_overflow(icon_view);
     xfdesktop_icon_view_size_grid(icon_view);
 
     g_object_freeze_notify(G_OBJECT(icon_view));
@@ -42,6 +42,12 @@ typedef struct {
     GList *dragged_icons;  // GtkTreeIter
 } XfdesktopDraggedIconList;
 
+typedef struct {
+    GtkTreeIter source_iter;
+    gint dest_row;
+    gint dest_col;
+} XfdesktopIconMove;
+
 guint xfdesktop_icon_view_get_icon_drag_info(void);
 GdkAtom xfdesktop_icon_view_get_icon_drag_target(void);
 
@@ -65,6 +65,7 @@ struct _XfdesktopRegularFileIcon
 
     gchar *display_name;
     gchar *tooltip;
+    GCancellable *tooltip_cancellable;
     GFileInfo *filesystem_info;
     GFile *thumbnail_file;
     GFileMonitor *monitor;
@@ -106,6 +107,7 @@ static void xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon
                                                          GFileInfo *info);
 static gboolean xfdesktop_regular_file_can_write_parent(XfdesktopFileIcon *icon);
 static gboolean xfdesktop_regular_file_icon_is_hidden_file(XfdesktopFileIcon *icon);
+static XfdesktopFileIconCategory xfdesktop_regular_file_icon_get_category(XfdesktopFileIcon *icon);
 
 static void cb_folder_contents_changed(GFileMonitor *monitor,
                                        GFile *file,
@@ -176,6 +178,7 @@ xfdesktop_regular_file_icon_class_init(XfdesktopRegularFileIconClass *klass)
     file_icon_class->can_rename_file = xfdesktop_regular_file_can_write_parent;
     file_icon_class->can_delete_file = xfdesktop_regular_file_can_write_parent;
     file_icon_class->is_hidden_file = xfdesktop_regular_file_icon_is_hidden_file;
+    file_icon_class->get_category = xfdesktop_regular_file_icon_get_category;
 
     g_object_class_install_property(gobject_class,
                                     PROP_CHANNEL,
@@ -339,6 +342,11 @@ xfdesktop_regular_file_icon_finalize(GObject *obj)
 
     g_free(icon->display_name);
 
+    if (icon->tooltip_cancellable != NULL) {
+        g_cancellable_cancel(icon->tooltip_cancellable);
+        g_object_unref(icon->tooltip_cancellable);
+    }
+
     if(icon->tooltip)
         g_free(icon->tooltip);
 
@@ -680,77 +688,170 @@ xfdesktop_regular_file_icon_peek_label(XfdesktopIcon *icon)
     return regular_file_icon->display_name;
 }
 
+typedef struct {
+    GFile *file;
+    gchar *display_name;
+    gchar *content_type;
+    gchar *size_string;
+    gchar *time_string;
+    gboolean is_desktop_file;
+} TooltipData;
+
+// content type -> description; shared by all icons, and filled from the
+// tooltip worker threads.
+static GHashTable *content_type_descriptions = NULL;
+G_LOCK_DEFINE_STATIC(content_type_descriptions);
+
+static void
+tooltip_data_free(TooltipData *tdata) {
+    g_object_unref(tdata->file);
+    g_free(tdata->display_name);
+    g_free(tdata->content_type);
+    g_free(tdata->size_string);
+    g_free(tdata->time_string);
+    g_slice_free(TooltipData, tdata);
+}
+
+static gchar *
+lookup_content_type_description(const gchar *content_type) {
+    gchar *description;
+
+    G_LOCK(content_type_descriptions);
+    if (content_type_descriptions == NULL) {
+        content_type_descriptions = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    }
+    description = g_strdup(g_hash_table_lookup(content_type_descriptions, content_type));
+    G_UNLOCK(content_type_descriptions);
+
+    if (description == NULL) {
+        // Looking this up can hit the disk the first time, so don't hold the
+        // lock while doing it; at worst two threads both look it up.
+        description = g_content_type_get_description(content_type);
+
+        G_LOCK(content_type_descriptions);
+        g_hash_table_replace(content_type_descriptions, g_strdup(content_type), g_strdup(description));
+        G_UNLOCK(content_type_descriptions);
+    }
+
+    return description;
+}
+
+static void
+build_tooltip_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    TooltipData *tdata = task_data;
+    gchar *description = lookup_content_type_description(tdata->content_type);
+    gchar *tooltip = g_strdup_printf(_("Name: %s\nType: %s\nSize: %s\nLast modified: %s"),
+                                     tdata->display_name,
+                                     description, tdata->size_string, tdata->time_string);
+    g_free(description);
+
+    /* Extract the Comment entry from the .desktop file */
+    if (tdata->is_desktop_file && !g_cancellable_is_cancelled(cancellable)) {
+        gchar *path = g_file_get_path(tdata->file);
+        XfceRc *rcfile = path != NULL ? xfce_rc_simple_open(path, TRUE) : NULL;
+        g_free(path);
+
+        if (rcfile != NULL) {
+            xfce_rc_set_group(rcfile, "Desktop Entry");
+            const gchar *comment = xfce_rc_read_entry(rcfile, "Comment", NULL);
+
+            /* Prepend the comment to the tooltip */
+            if (comment != NULL && *comment != '\0') {
+                gchar *with_comment = g_strdup_printf("%s\n%s", comment, tooltip);
+                g_free(tooltip);
+                tooltip = with_comment;
+            }
+
+            xfce_rc_close(rcfile);
+        }
+    }
+
+    g_task_return_pointer(task, tooltip, g_free);
+}
+
+static void
+tooltip_built(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GError *error = NULL;
+    gchar *tooltip = g_task_propagate_pointer(G_TASK(result), &error);
+
+    if (tooltip == NULL) {
+        // The worker never fails, so this can only be a cancellation.
+        g_clear_error(&error);
+    } else if (g_task_get_cancellable(G_TASK(result)) != NULL
+               && g_cancellable_is_cancelled(g_task_get_cancellable(G_TASK(result))))
+    {
+        // The file info changed while we were working; a newer tooltip
+        // will be built on the next hover.
+        g_free(tooltip);
+    } else {
+        XfdesktopRegularFileIcon *regular_file_icon = XFDESKTOP_REGULAR_FILE_ICON(source);
+
+        g_clear_object(&regular_file_icon->tooltip_cancellable);
+        g_free(regular_file_icon->tooltip);
+        regular_file_icon->tooltip = tooltip;
+
+        // The pointer is probably still over the icon that asked; have GTK
+        // ask again now that there's something to show.
+        gtk_tooltip_trigger_tooltip_query(gdk_screen_get_display(regular_file_icon->gscreen));
+    }
+}
+
+static void
+xfdesktop_regular_file_icon_invalidate_tooltip(XfdesktopRegularFileIcon *regular_file_icon) {
+    if (regular_file_icon->tooltip_cancellable != NULL) {
+        g_cancellable_cancel(regular_file_icon->tooltip_cancellable);
+        g_clear_object(&regular_file_icon->tooltip_cancellable);
+    }
+    g_clear_pointer(&regular_file_icon->tooltip, g_free);
+}
+
 static const gchar *
 xfdesktop_regular_file_icon_peek_tooltip(XfdesktopIcon *icon)
 {
     XfdesktopRegularFileIcon *regular_file_icon = XFDESKTOP_REGULAR_FILE_ICON(icon);
 
-    if(!regular_file_icon->tooltip) {
+    // The first time around, build the tooltip text off the main thread:
+    // the type description and a .desktop file's comment can both mean disk
+    // access.  Until it's ready, there's no tooltip.
+    if (regular_file_icon->tooltip == NULL && regular_file_icon->tooltip_cancellable == NULL) {
         GFileInfo *info = xfdesktop_file_icon_peek_file_info(XFDESKTOP_FILE_ICON(icon));
-        const gchar *content_type, *comment = NULL;
-        gchar *description, *size_string, *time_string;
-        guint64 size, mtime;
-        gboolean is_desktop_file = FALSE;
+        TooltipData *tdata;
 
         if(!info)
             return NULL;
 
-        if(g_content_type_equals(g_file_info_get_content_type(info),
-                                 "application/x-desktop"))
+        tdata = g_slice_new0(TooltipData);
+        tdata->file = g_object_ref(regular_file_icon->file);
+        tdata->display_name = g_strdup(regular_file_icon->display_name);
+        tdata->content_type = g_strdup(g_file_info_get_content_type(info) != NULL
+                                       ? g_file_info_get_content_type(info)
+                                       : "application/octet-stream");
+
+        if(g_content_type_equals(tdata->content_type, "application/x-desktop"))
         {
-            is_desktop_file = TRUE;
+            tdata->is_desktop_file = TRUE;
         }
         else
         {
           gchar *uri = g_file_get_uri(regular_file_icon->file);
           if(g_str_has_suffix(uri, ".desktop"))
-              is_desktop_file = TRUE;
+              tdata->is_desktop_file = TRUE;
           g_free(uri);
         }
 
-        content_type = g_file_info_get_content_type(info);
-        description = g_content_type_get_description(content_type);
-
-        size = g_file_info_get_attribute_uint64(info,
-                                                G_FILE_ATTRIBUTE_STANDARD_SIZE);
-
-        size_string = g_format_size(size);
-
-        mtime = g_file_info_get_attribute_uint64(info,
-                                                 G_FILE_ATTRIBUTE_TIME_MODIFIED);
-        time_string = xfdesktop_file_utils_format_time_for_display(mtime);
-
-        regular_file_icon->tooltip =
-            g_strdup_printf(_("Name: %s\nType: %s\nSize: %s\nLast modified: %s"),
-                            regular_file_icon->display_name,
-                            description, size_string, time_string);
+        // Formatting the time uses localtime(), which isn't thread-safe.
+        tdata->size_string = g_format_size(g_file_info_get_attribute_uint64(info,
+                                                                            G_FILE_ATTRIBUTE_STANDARD_SIZE));
+        tdata->time_string = xfdesktop_file_utils_format_time_for_display(g_file_info_get_attribute_uint64(info,
+                                                                                                           G_FILE_ATTRIBUTE_TIME_MODIFIED));
 
-        /* Extract the Comment entry from the .desktop file */
-        if(is_desktop_file)
-        {
-            gchar *path = g_file_get_path(regular_file_icon->file);
-            XfceRc *rcfile = xfce_rc_simple_open(path, TRUE);
-            g_free(path);
-
-            if(rcfile) {
-                xfce_rc_set_group(rcfile, "Desktop Entry");
-                comment = xfce_rc_read_entry(rcfile, "Comment", NULL);
-            }
-            /* Prepend the comment to the tooltip */
-            if(comment != NULL && *comment != '\0') {
-                gchar *tooltip = regular_file_icon->tooltip;
-                regular_file_icon->tooltip = g_strdup_printf("%s\n%s", comment, tooltip);
-                g_free(tooltip);
-            }
-
-            if (rcfile != NULL) {
-                xfce_rc_close(rcfile);
-            }
-        }
+        regular_file_icon->tooltip_cancellable = g_cancellable_new();
 
-        g_free(time_string);
-        g_free(size_string);
-        g_free(description);
+        GTask *task = g_task_new(regular_file_icon, regular_file_icon->tooltip_cancellable, tooltip_built, NULL);
+        g_task_set_task_data(task, tdata, (GDestroyNotify)tooltip_data_free);
+        g_task_set_return_on_cancel(task, TRUE);
+        g_task_run_in_thread(task, build_tooltip_thread);
+        g_object_unref(task);
     }
 
     return regular_file_icon->tooltip;
@@ -793,6 +894,13 @@ xfdesktop_regular_file_icon_is_hidden_file(XfdesktopFileIcon *icon) {
     return XFDESKTOP_REGULAR_FILE_ICON(icon)->is_hidden;
 }
 
+static XfdesktopFileIconCategory
+xfdesktop_regular_file_icon_get_category(XfdesktopFileIcon *icon) {
+    return XFDESKTOP_REGULAR_FILE_ICON(icon)->is_hidden
+        ? XFDESKTOP_FILE_ICON_CATEGORY_HIDDEN_FILE
+        : XFDESKTOP_FILE_ICON_CATEGORY_REGULAR_FILE;
+}
+
 static GFileInfo *
 xfdesktop_regular_file_icon_peek_file_info(XfdesktopFileIcon *icon)
 {
@@ -821,17 +929,16 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
     XfdesktopRegularFileIcon *regular_file_icon = XFDESKTOP_REGULAR_FILE_ICON(icon);
     const gchar *old_display_name;
     gchar *new_display_name;
+    GFileInfo *old_info;
+    gboolean tooltip_changed;
 
     g_return_if_fail(XFDESKTOP_IS_REGULAR_FILE_ICON(icon));
     g_return_if_fail(G_IS_FILE_INFO(info));
 
-    /* release the old file info */
-    if(regular_file_icon->file_info) {
-        g_object_unref(regular_file_icon->file_info);
-        regular_file_icon->file_info = NULL;
-    }
-
+    /* hang on to the old file info until we've compared it */
+    old_info = regular_file_icon->file_info;
     regular_file_icon->file_info = g_object_ref(info);
+    regular_file_icon->is_hidden = is_file_hidden(regular_file_icon->file, regular_file_icon->file_info);
 
     if(regular_file_icon->filesystem_info)
         g_object_unref(regular_file_icon->filesystem_info);
@@ -845,6 +952,17 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
     new_display_name = xfdesktop_file_utils_get_display_name(regular_file_icon->file,
                                                              regular_file_icon->file_info);
 
+    tooltip_changed = old_info == NULL
+        || g_strcmp0(old_display_name, new_display_name) != 0
+        || g_strcmp0(g_file_info_get_content_type(old_info), g_file_info_get_content_type(info)) != 0
+        || g_file_info_get_attribute_uint64(old_info, G_FILE_ATTRIBUTE_STANDARD_SIZE)
+           != g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_STANDARD_SIZE)
+        || g_file_info_get_attribute_uint64(old_info, G_FILE_ATTRIBUTE_TIME_MODIFIED)
+           != g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+    if (old_info != NULL) {
+        g_object_unref(old_info);
+    }
+
     /* check whether the display name has changed with the info update */
     if(g_strcmp0 (old_display_name, new_display_name) != 0) {
         /* replace the display name */
@@ -858,9 +976,10 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
         g_free (new_display_name);
     }
 
-    /* invalidate the tooltip */
-    g_free(regular_file_icon->tooltip);
-    regular_file_icon->tooltip = NULL;
+    /* invalidate the tooltip, if anything in it changed */
+    if (tooltip_changed) {
+        xfdesktop_regular_file_icon_invalidate_tooltip(regular_file_icon);
+    }
 
     /* not really easy to check if this changed or not, so just invalidate it */
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
@@ -48,6 +48,10 @@
 #include "xfdesktop-file-utils.h"
 #include "xfdesktop-special-file-icon.h"
 
+// Busy trash directories (or deleting thousands of files at once) can send
+// a flood of monitor events; recount the trash at most this often.
+#define TRASH_REFRESH_INTERVAL_MS 500
+
 struct _XfdesktopSpecialFileIcon
 {
     XfdesktopFileIcon parent_instance;
@@ -65,6 +69,10 @@ struct _XfdesktopSpecialFileIcon
     /* only needed for trash */
     GCancellable *children_enumerate;
     guint trash_item_count;
+    guint counting_trash_item_count;
+    gint64 trash_count_last_started;
+    guint trash_refresh_id;
+    gboolean trash_refresh_queued;
 };
 
 static void xfdesktop_special_file_icon_finalize(GObject *obj);
@@ -78,12 +86,14 @@ static GIcon * xfdesktop_special_file_icon_get_gicon(XfdesktopFileIcon *icon);
 static GFileInfo *xfdesktop_special_file_icon_peek_file_info(XfdesktopFileIcon *icon);
 static GFileInfo *xfdesktop_special_file_icon_peek_filesystem_info(XfdesktopFileIcon *icon);
 static GFile *xfdesktop_special_file_icon_peek_file(XfdesktopFileIcon *icon);
+static XfdesktopFileIconCategory xfdesktop_special_file_icon_get_category(XfdesktopFileIcon *icon);
 static void xfdesktop_special_file_icon_changed(GFileMonitor *monitor,
                                                 GFile *file,
                                                 GFile *other_file,
                                                 GFileMonitorEvent event,
                                                 XfdesktopSpecialFileIcon *special_file_icon);
 static void xfdesktop_special_file_icon_update_trash_count(XfdesktopSpecialFileIcon *special_file_icon);
+static void schedule_trash_refresh(XfdesktopSpecialFileIcon *special_file_icon);
 
 static void start_metadata_update(XfdesktopSpecialFileIcon *special_file_icon);
 
@@ -117,6 +127,7 @@ xfdesktop_special_file_icon_class_init(XfdesktopSpecialFileIconClass *klass)
     file_icon_class->peek_file_info = xfdesktop_special_file_icon_peek_file_info;
     file_icon_class->peek_filesystem_info = xfdesktop_special_file_icon_peek_filesystem_info;
     file_icon_class->peek_file = xfdesktop_special_file_icon_peek_file;
+    file_icon_class->get_category = xfdesktop_special_file_icon_get_category;
 }
 
 static void
@@ -134,6 +145,9 @@ xfdesktop_special_file_icon_finalize(GObject *obj)
         g_object_unref(icon->monitor);
     }
 
+    if (icon->trash_refresh_id != 0) {
+        g_source_remove(icon->trash_refresh_id);
+    }
     if (icon->children_enumerate != NULL) {
         g_cancellable_cancel(icon->children_enumerate);
         g_object_unref(icon->children_enumerate);
@@ -413,6 +427,21 @@ xfdesktop_special_file_icon_peek_filesystem_info(XfdesktopFileIcon *icon)
     return XFDESKTOP_SPECIAL_FILE_ICON(icon)->filesystem_info;
 }
 
+static XfdesktopFileIconCategory
+xfdesktop_special_file_icon_get_category(XfdesktopFileIcon *icon) {
+    switch (XFDESKTOP_SPECIAL_FILE_ICON(icon)->type) {
+        case XFDESKTOP_SPECIAL_FILE_ICON_HOME:
+            return XFDESKTOP_FILE_ICON_CATEGORY_HOME;
+        case XFDESKTOP_SPECIAL_FILE_ICON_FILESYSTEM:
+            return XFDESKTOP_FILE_ICON_CATEGORY_FILESYSTEM;
+        case XFDESKTOP_SPECIAL_FILE_ICON_TRASH:
+            return XFDESKTOP_FILE_ICON_CATEGORY_TRASH;
+        default:
+            g_assert_not_reached();
+            return XFDESKTOP_FILE_ICON_CATEGORY_NONE;
+    }
+}
+
 static GFile *
 xfdesktop_special_file_icon_peek_file(XfdesktopFileIcon *icon)
 {
@@ -437,7 +466,13 @@ xfdesktop_special_file_icon_changed(GFileMonitor *monitor,
        event == G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
         return;
 
-    start_metadata_update(special_file_icon);
+    if (special_file_icon->type == XFDESKTOP_SPECIAL_FILE_ICON_TRASH && special_file_icon->file_info != NULL) {
+        // Items coming and going only changes the trash's count, not the
+        // trash folder's own metadata.
+        schedule_trash_refresh(special_file_icon);
+    } else {
+        start_metadata_update(special_file_icon);
+    }
 }
 
 static void
@@ -446,6 +481,32 @@ child_file_enumerator_close_done(GObject *source, GAsyncResult *result, gpointer
     g_object_unref(source);
 }
 
+static void
+trash_count_finished(XfdesktopSpecialFileIcon *icon, gboolean succeeded) {
+    g_clear_object(&icon->children_enumerate);
+
+    if (succeeded && icon->counting_trash_item_count != icon->trash_item_count) {
+        gboolean was_empty = icon->trash_item_count == 0;
+        gboolean is_empty = icon->counting_trash_item_count == 0;
+
+        DBG("trash count changed from %u to %u", icon->trash_item_count, icon->counting_trash_item_count);
+        icon->trash_item_count = icon->counting_trash_item_count;
+        g_clear_pointer(&icon->tooltip, g_free);
+
+        if (was_empty != is_empty) {
+            xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
+            xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(icon));
+        }
+    }
+
+    if (icon->trash_refresh_queued) {
+        // The trash changed while we were counting, so this count might
+        // already be stale.
+        icon->trash_refresh_queued = FALSE;
+        schedule_trash_refresh(icon);
+    }
+}
+
 static void
 child_files_ready(GObject *source, GAsyncResult *result, gpointer data) {
     GError *error = NULL;
@@ -455,18 +516,11 @@ child_files_ready(GObject *source, GAsyncResult *result, gpointer data) {
         if (error != NULL) {
             if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
                 g_message("Failed to count number of items in trash: %s", error->message);
-
-                XfdesktopSpecialFileIcon *icon = XFDESKTOP_SPECIAL_FILE_ICON(data);
-                g_clear_object(&icon->children_enumerate);
+                trash_count_finished(XFDESKTOP_SPECIAL_FILE_ICON(data), FALSE);
             }
             g_error_free(error);
         } else {
-            XfdesktopSpecialFileIcon *icon = XFDESKTOP_SPECIAL_FILE_ICON(data);
-            g_clear_object(&icon->children_enumerate);
-            g_clear_pointer(&icon->tooltip, g_free);
-
-            xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
-            xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(icon));
+            trash_count_finished(XFDESKTOP_SPECIAL_FILE_ICON(data), TRUE);
         }
 
         g_file_enumerator_close_async(G_FILE_ENUMERATOR(source),
@@ -476,7 +530,7 @@ child_files_ready(GObject *source, GAsyncResult *result, gpointer data) {
                                       NULL);
     } else {
         XfdesktopSpecialFileIcon *icon = XFDESKTOP_SPECIAL_FILE_ICON(data);
-        icon->trash_item_count += g_list_length(file_infos);
+        icon->counting_trash_item_count += g_list_length(file_infos);
         g_list_free_full(file_infos, g_object_unref);
 
         g_file_enumerator_next_files_async(G_FILE_ENUMERATOR(source),
@@ -496,9 +550,7 @@ child_enumerator_ready(GObject *source, GAsyncResult *result, gpointer data) {
     if (enumerator == NULL) {
         if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
             g_message("Failed to count number of items in trash: %s", error->message);
-
-            XfdesktopSpecialFileIcon *icon = XFDESKTOP_SPECIAL_FILE_ICON(data);
-            g_clear_object(&icon->children_enumerate);
+            trash_count_finished(XFDESKTOP_SPECIAL_FILE_ICON(data), FALSE);
         }
         g_error_free(error);
     } else {
@@ -525,13 +577,21 @@ xfdesktop_special_file_icon_update_trash_count(XfdesktopSpecialFileIcon *special
         return;
     }
 
+    if (special_file_icon->trash_refresh_id != 0) {
+        g_source_remove(special_file_icon->trash_refresh_id);
+        special_file_icon->trash_refresh_id = 0;
+    }
     if (special_file_icon->children_enumerate != NULL) {
         g_cancellable_cancel(special_file_icon->children_enumerate);
         g_clear_object(&special_file_icon->children_enumerate);
     }
     special_file_icon->children_enumerate = g_cancellable_new();
+    special_file_icon->trash_refresh_queued = FALSE;
 
-    special_file_icon->trash_item_count = 0;
+    // Count into a separate field so the icon and tooltip keep showing the
+    // old count until the new one is complete.
+    special_file_icon->counting_trash_item_count = 0;
+    special_file_icon->trash_count_last_started = g_get_monotonic_time();
 
     /* The trash count may return a number of files the user can't
      * currently delete, for example if the file is in a removable
@@ -546,6 +606,28 @@ xfdesktop_special_file_icon_update_trash_count(XfdesktopSpecialFileIcon *special
                                            special_file_icon);
 }
 
+static gboolean
+trash_refresh_timeout(gpointer data) {
+    XfdesktopSpecialFileIcon *special_file_icon = XFDESKTOP_SPECIAL_FILE_ICON(data);
+    special_file_icon->trash_refresh_id = 0;
+    xfdesktop_special_file_icon_update_trash_count(special_file_icon);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_trash_refresh(XfdesktopSpecialFileIcon *special_file_icon) {
+    if (special_file_icon->children_enumerate != NULL) {
+        // Counting already; go again once it's done.
+        special_file_icon->trash_refresh_queued = TRUE;
+    } else if (special_file_icon->trash_refresh_id == 0) {
+        gint64 since_last_ms = (g_get_monotonic_time() - special_file_icon->trash_count_last_started) / 1000;
+        guint delay_ms = since_last_ms >= TRASH_REFRESH_INTERVAL_MS
+            ? 0
+            : TRASH_REFRESH_INTERVAL_MS - since_last_ms;
+        special_file_icon->trash_refresh_id = g_timeout_add(delay_ms, trash_refresh_timeout, special_file_icon);
+    }
+}
+
 static void
 filesystem_info_loaded(GObject *source, GAsyncResult *result, gpointer data) {
     GError *error = NULL;
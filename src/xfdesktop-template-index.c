@@ -0,0 +1,313 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "xfdesktop-template-index.h"
+
+#define REBUILD_DELAY_MS 500
+
+#define TEMPLATE_ATTRIBUTES \
+    G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+    G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+    G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+    G_FILE_ATTRIBUTE_STANDARD_ICON "," \
+    G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+    G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP
+
+struct _XfdesktopTemplateIndex {
+    GFile *templates_dir;
+
+    XfdesktopTemplateNode *root;
+    GList *monitors;  // GFileMonitor (owner), one per directory in the tree
+
+    GCancellable *cancellable;
+    guint rebuild_id;
+};
+
+typedef struct {
+    XfdesktopTemplateNode *root;
+    GList *dirs;  // GFile (owner), every directory visited, including empty ones
+} ScanResult;
+
+static void schedule_rebuild(XfdesktopTemplateIndex *index);
+
+static void
+template_node_free(XfdesktopTemplateNode *node) {
+    if (node != NULL) {
+        g_object_unref(node->file);
+        g_free(node->display_name);
+        g_free(node->label);
+        if (node->icon != NULL) {
+            g_object_unref(node->icon);
+        }
+        if (node->children != NULL) {
+            g_ptr_array_free(node->children, TRUE);
+        }
+        g_free(node);
+    }
+}
+
+static void
+scan_result_free(ScanResult *result) {
+    template_node_free(result->root);
+    g_list_free_full(result->dirs, g_object_unref);
+    g_free(result);
+}
+
+static gint
+compare_template_nodes(gconstpointer a, gconstpointer b) {
+    const XfdesktopTemplateNode *node_a = *(XfdesktopTemplateNode **)a;
+    const XfdesktopTemplateNode *node_b = *(XfdesktopTemplateNode **)b;
+    gboolean is_dir_a = node_a->children != NULL;
+    gboolean is_dir_b = node_b->children != NULL;
+
+    if (is_dir_a == is_dir_b) {
+        return g_strcmp0(node_a->display_name, node_b->display_name);
+    } else if (is_dir_a) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+static XfdesktopTemplateNode *
+template_node_new(GFile *file, GFileInfo *info) {
+    XfdesktopTemplateNode *node = g_new0(XfdesktopTemplateNode, 1);
+    node->file = g_object_ref(file);
+
+    node->display_name = g_strdup(g_file_info_get_display_name(info));
+    node->label = g_strdup(node->display_name);
+    gchar *dot = g_utf8_strrchr(node->label, -1, '.');
+    if (dot != NULL) {
+        *dot = '\0';
+    }
+
+    GIcon *icon = g_file_info_get_icon(info);
+    if (icon != NULL) {
+        node->icon = g_object_ref(icon);
+    }
+
+    return node;
+}
+
+// Runs on a worker thread.  Returns the directory's children, or NULL if it
+// (recursively) contains no templates.
+static GPtrArray *
+scan_directory(GFile *dir, GList **dirs, GCancellable *cancellable) {
+    *dirs = g_list_prepend(*dirs, g_object_ref(dir));
+
+    GFileEnumerator *enumerator = g_file_enumerate_children(dir,
+                                                            TEMPLATE_ATTRIBUTES,
+                                                            G_FILE_QUERY_INFO_NONE,
+                                                            cancellable,
+                                                            NULL);
+    if (enumerator == NULL) {
+        return NULL;
+    }
+
+    GPtrArray *children = g_ptr_array_new_with_free_func((GDestroyNotify)template_node_free);
+
+    GFileInfo *info;
+    while ((info = g_file_enumerator_next_file(enumerator, cancellable, NULL)) != NULL) {
+        /* skip hidden & backup files */
+        if (!g_file_info_get_is_hidden(info) && !g_file_info_get_is_backup(info)) {
+            GFile *file = g_file_get_child(dir, g_file_info_get_name(info));
+
+            if (g_file_info_get_file_type(info) == G_FILE_TYPE_DIRECTORY) {
+                GPtrArray *subchildren = scan_directory(file, dirs, cancellable);
+                if (subchildren != NULL) {
+                    XfdesktopTemplateNode *node = template_node_new(file, info);
+                    node->children = subchildren;
+                    g_ptr_array_add(children, node);
+                }
+            } else {
+                g_ptr_array_add(children, template_node_new(file, info));
+            }
+
+            g_object_unref(file);
+        }
+
+        g_object_unref(info);
+    }
+
+    g_object_unref(enumerator);
+
+    if (children->len == 0) {
+        g_ptr_array_free(children, TRUE);
+        return NULL;
+    } else {
+        g_ptr_array_sort(children, compare_template_nodes);
+        return children;
+    }
+}
+
+static void
+scan_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    GFile *templates_dir = task_data;
+    gint64 start = g_get_monotonic_time();
+
+    ScanResult *result = g_new0(ScanResult, 1);
+    result->root = g_new0(XfdesktopTemplateNode, 1);
+    result->root->file = g_object_ref(templates_dir);
+    result->root->children = scan_directory(templates_dir, &result->dirs, cancellable);
+    if (result->root->children == NULL) {
+        result->root->children = g_ptr_array_new_with_free_func((GDestroyNotify)template_node_free);
+    }
+
+    DBG("scanned %u template directories in %.3fms",
+        g_list_length(result->dirs),
+        (g_get_monotonic_time() - start) / 1000.0);
+
+    if (g_task_return_error_if_cancelled(task)) {
+        scan_result_free(result);
+    } else {
+        g_task_return_pointer(task, result, (GDestroyNotify)scan_result_free);
+    }
+}
+
+static void
+template_dir_changed(GFileMonitor *monitor,
+                     GFile *file,
+                     GFile *other_file,
+                     GFileMonitorEvent event,
+                     XfdesktopTemplateIndex *index)
+{
+    switch (event) {
+        case G_FILE_MONITOR_EVENT_CREATED:
+        case G_FILE_MONITOR_EVENT_DELETED:
+        case G_FILE_MONITOR_EVENT_MOVED:
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+        case G_FILE_MONITOR_EVENT_MOVED_OUT:
+        case G_FILE_MONITOR_EVENT_RENAMED:
+        case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+            schedule_rebuild(index);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void
+clear_monitors(XfdesktopTemplateIndex *index) {
+    for (GList *l = index->monitors; l != NULL; l = l->next) {
+        g_signal_handlers_disconnect_by_data(l->data, index);
+        g_file_monitor_cancel(G_FILE_MONITOR(l->data));
+    }
+    g_list_free_full(index->monitors, g_object_unref);
+    index->monitors = NULL;
+}
+
+static void
+scan_done(GObject *source, GAsyncResult *res, gpointer user_data) {
+    GError *error = NULL;
+    ScanResult *result = g_task_propagate_pointer(G_TASK(res), &error);
+    if (result == NULL) {
+        // Only cancelled when a newer scan replaced us or the index is gone.
+        g_error_free(error);
+        return;
+    }
+
+    XfdesktopTemplateIndex *index = user_data;
+    g_clear_object(&index->cancellable);
+
+    template_node_free(index->root);
+    index->root = g_steal_pointer(&result->root);
+
+    clear_monitors(index);
+    for (GList *l = result->dirs; l != NULL; l = l->next) {
+        GFileMonitor *monitor = g_file_monitor_directory(G_FILE(l->data), G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+        if (monitor != NULL) {
+            g_signal_connect(monitor, "changed",
+                             G_CALLBACK(template_dir_changed), index);
+            index->monitors = g_list_prepend(index->monitors, monitor);
+        }
+    }
+
+    scan_result_free(result);
+}
+
+static void
+start_scan(XfdesktopTemplateIndex *index) {
+    if (index->cancellable != NULL) {
+        g_cancellable_cancel(index->cancellable);
+        g_object_unref(index->cancellable);
+    }
+    index->cancellable = g_cancellable_new();
+
+    GTask *task = g_task_new(NULL, index->cancellable, scan_done, index);
+    g_task_set_source_tag(task, start_scan);
+    g_task_set_task_data(task, g_object_ref(index->templates_dir), g_object_unref);
+    g_task_run_in_thread(task, scan_thread);
+    g_object_unref(task);
+}
+
+static gboolean
+rebuild_timeout(gpointer data) {
+    XfdesktopTemplateIndex *index = data;
+    index->rebuild_id = 0;
+    start_scan(index);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_rebuild(XfdesktopTemplateIndex *index) {
+    // Copying a template tree in produces a burst of events; only rescan
+    // once things have settled down.
+    if (index->rebuild_id != 0) {
+        g_source_remove(index->rebuild_id);
+    }
+    index->rebuild_id = g_timeout_add(REBUILD_DELAY_MS, rebuild_timeout, index);
+}
+
+XfdesktopTemplateIndex *
+xfdesktop_template_index_new(GFile *templates_dir) {
+    g_return_val_if_fail(G_IS_FILE(templates_dir), NULL);
+
+    XfdesktopTemplateIndex *index = g_new0(XfdesktopTemplateIndex, 1);
+    index->templates_dir = g_object_ref(templates_dir);
+    start_scan(index);
+
+    return index;
+}
+
+const XfdesktopTemplateNode *
+xfdesktop_template_index_peek_root(XfdesktopTemplateIndex *index) {
+    g_return_val_if_fail(index != NULL, NULL);
+    return index->root;
+}
+
+void
+xfdesktop_template_index_free(XfdesktopTemplateIndex *index) {
+    if (index != NULL) {
+        if (index->rebuild_id != 0) {
+            g_source_remove(index->rebuild_id);
+        }
+        if (index->cancellable != NULL) {
+            g_cancellable_cancel(index->cancellable);
+            g_object_unref(index->cancellable);
+        }
+        clear_monitors(index);
+        template_node_free(index->root);
+        g_object_unref(index->templates_dir);
+        g_free(index);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __XFDESKTOP_TEMPLATE_INDEX_H__
+#define __XFDESKTOP_TEMPLATE_INDEX_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfdesktopTemplateIndex XfdesktopTemplateIndex;
+
+typedef struct _XfdesktopTemplateNode {
+    GFile *file;
+    gchar *display_name;
+    gchar *label;  // display name with the extension stripped
+    GIcon *icon;
+    GPtrArray *children;  // XfdesktopTemplateNode (owner), sorted; NULL for regular files
+} XfdesktopTemplateNode;
+
+XfdesktopTemplateIndex *xfdesktop_template_index_new(GFile *templates_dir);
+
+// Returns NULL until the first scan has finished.  Directories without any
+// templates in them (recursively) are not part of the tree.
+const XfdesktopTemplateNode *xfdesktop_template_index_peek_root(XfdesktopTemplateIndex *index);
+
+void xfdesktop_template_index_free(XfdesktopTemplateIndex *index);
+
+G_END_DECLS
+
+#endif /* __XFDESKTOP_TEMPLATE_INDEX_H__ */
@@ -82,6 +82,7 @@ static gdouble xfdesktop_volume_icon_get_opacity(XfdesktopFileIcon *icon);
 static GFileInfo *xfdesktop_volume_icon_peek_file_info(XfdesktopFileIcon *icon);
 static GFileInfo *xfdesktop_volume_icon_peek_filesystem_info(XfdesktopFileIcon *icon);
 static GFile *xfdesktop_volume_icon_peek_file(XfdesktopFileIcon *icon);
+static XfdesktopFileIconCategory xfdesktop_volume_icon_get_category(XfdesktopFileIcon *icon);
 static void xfdesktop_volume_icon_update_file_info(XfdesktopFileIcon *icon,
                                                    GFileInfo *info);
 static gboolean xfdesktop_volume_icon_activate(XfdesktopIcon *icon,
@@ -146,6 +147,7 @@ xfdesktop_volume_icon_class_init(XfdesktopVolumeIconClass *klass)
     file_icon_class->peek_filesystem_info = xfdesktop_volume_icon_peek_filesystem_info;
     file_icon_class->peek_file = xfdesktop_volume_icon_peek_file;
     file_icon_class->update_file_info = xfdesktop_volume_icon_update_file_info;
+    file_icon_class->get_category = xfdesktop_volume_icon_get_category;
     file_icon_class->hash = xfdesktop_volume_icon_hash;
     file_icon_class->get_sort_key = xfdesktop_volume_icon_get_sort_key;
 }
@@ -526,6 +528,7 @@ xfdesktop_volume_icon_mount_finish(GObject *object,
     } else {
         g_clear_object(&icon->mount);
         icon->mount = g_volume_get_mount(volume);
+        xfdesktop_file_icon_invalidate_category(XFDESKTOP_FILE_ICON(icon));
 
         if (icon->mount != NULL) {
             g_clear_object(&icon->file);
@@ -844,6 +847,85 @@ xfdesktop_volume_icon_peek_file(XfdesktopFileIcon *icon)
     return XFDESKTOP_VOLUME_ICON(icon)->file;
 }
 
+static XfdesktopFileIconCategory
+volume_category(GVolume *volume) {
+    gboolean is_removable = g_volume_can_eject(volume);
+    if (!is_removable) {
+        GDrive *drive = g_volume_get_drive(volume);
+        if (drive != NULL) {
+            is_removable = g_drive_is_removable(drive);
+            g_object_unref(drive);
+        }
+    }
+
+    XfdesktopFileIconCategory category = XFDESKTOP_FILE_ICON_CATEGORY_NONE;
+    gchar *volume_type = g_volume_get_identifier(volume, G_VOLUME_IDENTIFIER_KIND_CLASS);
+    if (g_strcmp0(volume_type, "network") == 0) {
+        category = XFDESKTOP_FILE_ICON_CATEGORY_NETWORK_VOLUME;
+    } else if (g_strcmp0(volume_type, "device") == 0) {
+        category = is_removable
+            ? XFDESKTOP_FILE_ICON_CATEGORY_REMOVABLE_DEVICE_VOLUME
+            : XFDESKTOP_FILE_ICON_CATEGORY_FIXED_DEVICE_VOLUME;
+    } else if (volume_type == NULL || g_strcmp0(volume_type, "loop") == 0) {
+        category = XFDESKTOP_FILE_ICON_CATEGORY_UNKNOWN_VOLUME;
+    }
+    g_free(volume_type);
+
+    return category;
+}
+
+static XfdesktopFileIconCategory
+mount_category(GMount *mount) {
+    GFile *root = g_mount_get_root(mount);
+    if (root != NULL) {
+        gboolean is_ignored_scheme =
+            g_file_has_uri_scheme(root, "gphoto2")
+            || g_file_has_uri_scheme(root, "mtp")
+            || g_file_has_uri_scheme(root, "cdda");
+        g_object_unref(root);
+        if (is_ignored_scheme) {
+            return XFDESKTOP_FILE_ICON_CATEGORY_NONE;
+        }
+    }
+
+    gboolean is_removable;
+    gboolean is_local;
+    GDrive *drive = g_mount_get_drive(mount);
+    if (drive != NULL) {
+        is_removable = g_drive_is_removable(drive) || g_mount_can_eject(mount);
+
+        gchar *unix_device = g_drive_get_identifier(drive, G_DRIVE_IDENTIFIER_KIND_UNIX_DEVICE);
+        is_local = unix_device != NULL && unix_device[0] != '\0';
+        g_free(unix_device);
+
+        g_object_unref(drive);
+    } else {
+        is_removable = g_mount_can_eject(mount);
+        is_local = FALSE;  // Very weak guess, maybe should look at URI
+    }
+
+    if (is_removable) {
+        return XFDESKTOP_FILE_ICON_CATEGORY_REMOVABLE_MOUNT;
+    } else if (is_local) {
+        return XFDESKTOP_FILE_ICON_CATEGORY_LOCAL_MOUNT;
+    } else {
+        return XFDESKTOP_FILE_ICON_CATEGORY_NETWORK_MOUNT;
+    }
+}
+
+static XfdesktopFileIconCategory
+xfdesktop_volume_icon_get_category(XfdesktopFileIcon *icon) {
+    XfdesktopVolumeIcon *volume_icon = XFDESKTOP_VOLUME_ICON(icon);
+
+    if (volume_icon->volume != NULL) {
+        return volume_category(volume_icon->volume);
+    } else if (volume_icon->mount != NULL) {
+        return mount_category(volume_icon->mount);
+    } else {
+        return XFDESKTOP_FILE_ICON_CATEGORY_NONE;
+    }
+}
+
 static void
 xfdesktop_volume_icon_update_file_info(XfdesktopFileIcon *icon,
                                        GFileInfo *info)
@@ -1067,6 +1149,7 @@ xfdesktop_volume_icon_mounted(XfdesktopVolumeIcon *icon, GMount *mount) {
 
         icon->mount = g_object_ref(mount);
         icon->file = g_mount_get_root(icon->mount);
+        xfdesktop_file_icon_invalidate_category(XFDESKTOP_FILE_ICON(icon));
 
         xfdesktop_volume_icon_fetch_file_info(icon, xfdesktop_volume_icon_file_info_ready);
         xfdesktop_volume_icon_fetch_filesystem_info(icon);
@@ -1087,6 +1170,7 @@ xfdesktop_volume_icon_unmounted(XfdesktopVolumeIcon *icon) {
         g_clear_object(&icon->file);
         g_clear_object(&icon->file_info);
         g_clear_object(&icon->filesystem_info);
+        xfdesktop_file_icon_invalidate_category(XFDESKTOP_FILE_ICON(icon));
 
         g_clear_pointer(&icon->tooltip, g_free);
 
@@ -540,6 +540,20 @@ icon_view_icon_moved(XfdesktopIconView *icon_view,
     }
 }
 
+static void
+icon_view_icons_moved(XfdesktopIconView *icon_view,
+                      XfdesktopIconView *source_icon_view,
+                      GArray *moves,
+                      MonitorData *mdata)
+{
+    TRACE("entering, %u icons", moves->len);
+
+    for (guint i = 0; i < moves->len; ++i) {
+        XfdesktopIconMove *move = &g_array_index(moves, XfdesktopIconMove, i);
+        icon_view_icon_moved(icon_view, source_icon_view, &move->source_iter, move->dest_row, move->dest_col, mdata);
+    }
+}
+
 static void
 icon_view_drag_data_get(GtkWidget *icon_view,
                         GdkDragContext *context,
@@ -644,6 +658,8 @@ create_icon_view(XfdesktopWindowIconManager *wmanager, XfceDesktop *desktop) {
                      G_CALLBACK(icon_view_icon_activated), mdata);
     g_signal_connect(icon_view, "icon-moved",
                      G_CALLBACK(icon_view_icon_moved), mdata);
+    g_signal_connect(icon_view, "icons-moved",
+                     G_CALLBACK(icon_view_icons_moved), mdata);
 
     // DnD source signals
     g_signal_connect(icon_view, "drag-data-get",
@@ -0,0 +1,102 @@
+#ifndef __ICON_POSITION_FIXTURES_H__
+#define __ICON_POSITION_FIXTURES_H__
+
+// Shared by the icon position tests; include it after
+// xfdesktop-icon-position-configs.c.  Everything here is static inline so
+// programs that don't use all of it don't get unused function warnings.
+
+#include <glib.h>
+#include <stdio.h>
+
+// Icons are named after their index, so tests can look them up again.
+static inline gchar *
+icon_position_fixture_icon_name(guint i) {
+    return g_strdup_printf("file-%05u.txt", i);
+}
+
+// Writes @n_configs configs, each for a monitor of its own ("monitor-0",
+// "monitor-1", ...) and with levels cycling through 0-2, and puts every one
+// of @n_icons icons in each of them.
+static inline gboolean
+icon_position_fixture_write(const gchar *filename, guint n_configs, guint n_icons) {
+    FILE *out = fopen(filename, "w");
+    if (out == NULL) {
+        return FALSE;
+    }
+
+    fputs("configs:\n", out);
+    for (guint c = 0; c < n_configs; ++c) {
+        fprintf(out,
+                "  - level: %u\n"
+                "    monitors:\n"
+                "      - id: monitor-%u\n"
+                "        display_name: \"Monitor %u\"\n"
+                "        geometry:\n"
+                "          x: %u\n"
+                "          y: 0\n"
+                "          width: 1920\n"
+                "          height: 1080\n"
+                "    icons:\n",
+                c % 3, c, c, c * 1920);
+        for (guint i = 0; i < n_icons; ++i) {
+            fprintf(out,
+                    "      \"file-%05u.txt\":\n"
+                    "        row: %u\n"
+                    "        col: %u\n"
+                    "        last_seen: %u\n",
+                    i, (i + c) % 40, c, i * 1000 + c);
+        }
+    }
+
+    return fclose(out) == 0;
+}
+
+static inline XfdesktopIconPositionConfigs *
+icon_position_fixture_load(const gchar *filename, GError **error) {
+    GFile *file = g_file_new_for_path(filename);
+    XfdesktopIconPositionConfigs *configs = xfdesktop_icon_position_configs_new(file);
+    g_object_unref(file);
+
+    if (!xfdesktop_icon_position_configs_load(configs, error)) {
+        xfdesktop_icon_position_configs_free(configs);
+        return NULL;
+    }
+
+    return configs;
+}
+
+// Whether the sidecar cache next to @filename is intact and matches the
+// YAML as it is now, i.e. whether the next load will be served from it.
+static inline gboolean
+icon_position_fixture_cache_is_current(const gchar *filename) {
+    guint64 yaml_mtime, yaml_size;
+    if (!get_yaml_stamp(filename, &yaml_mtime, &yaml_size)) {
+        return FALSE;
+    }
+
+    GFile *file = g_file_new_for_path(filename);
+    XfdesktopIconPositionConfigs *scratch = xfdesktop_icon_position_configs_new(file);
+    g_object_unref(file);
+
+    gboolean current = load_cache(scratch, yaml_mtime, yaml_size);
+    xfdesktop_icon_position_configs_free(scratch);
+    return current;
+}
+
+// A load that had to parse the YAML writes the cache in the background;
+// wait for it to land so it doesn't race with whatever comes next.
+static inline gboolean
+icon_position_fixture_wait_for_cache(const gchar *filename) {
+    gint64 deadline = g_get_monotonic_time() + 30 * G_USEC_PER_SEC;
+    while (!icon_position_fixture_cache_is_current(filename)) {
+        if (g_get_monotonic_time() > deadline) {
+            return FALSE;
+        }
+        while (g_main_context_iteration(NULL, FALSE)) {
+        }
+        g_usleep(G_USEC_PER_SEC / 100);
+    }
+    return TRUE;
+}
+
+#endif /* __ICON_POSITION_FIXTURES_H__ */
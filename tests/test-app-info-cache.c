@@ -0,0 +1,136 @@
+#include <gio/gio.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+#include "xfdesktop-app-info-cache.c"
+
+#define N_SELECTED 10000
+
+static const struct {
+    const gchar *name;
+    const gchar *mime_types;
+} test_apps[] = {
+    { "editor", "text/plain;text/x-csrc;text/x-chdr;" },
+    { "other-editor", "text/x-csrc;text/plain;text/x-chdr;" },
+    { "viewer", "image/png;" },
+};
+
+static gchar *
+desktop_file_path(const gchar *apps_dir, const gchar *name) {
+    return g_strdup_printf("%s/%s.desktop", apps_dir, name);
+}
+
+static void
+write_desktop_file(const gchar *apps_dir, const gchar *name, const gchar *mime_types) {
+    gchar *filename = desktop_file_path(apps_dir, name);
+    gchar *contents = g_strdup_printf("[Desktop Entry]\n"
+                                      "Type=Application\n"
+                                      "Name=%s\n"
+                                      "Exec=true %%f\n"
+                                      "MimeType=%s\n",
+                                      name,
+                                      mime_types);
+    g_file_set_contents(filename, contents, -1, NULL);
+    g_free(contents);
+    g_free(filename);
+}
+
+static gboolean
+check_selection(XfdesktopAppInfoCache *cache,
+                const gchar *description,
+                const gchar *const *pattern,
+                gsize pattern_len,
+                gboolean expected,
+                guint expected_new_lookups)
+{
+    const gchar **content_types = g_new(const gchar *, N_SELECTED);
+    for (gsize i = 0; i < N_SELECTED; ++i) {
+        content_types[i] = pattern[i % pattern_len];
+    }
+
+    guint lookups_before = cache->n_lookups;
+    gint64 start = g_get_monotonic_time();
+    gboolean result = xfdesktop_app_info_cache_share_handlers(cache, (const gchar *const *)content_types, N_SELECTED);
+    gint64 elapsed = g_get_monotonic_time() - start;
+    guint new_lookups = cache->n_lookups - lookups_before;
+
+    g_free(content_types);
+
+    g_print("%s: %s in %.3f ms, %u new lookups\n",
+            description,
+            result ? "same handlers" : "different handlers",
+            elapsed / 1000.0,
+            new_lookups);
+
+    if (result != expected) {
+        g_printerr("%s: expected %s\n", description, expected ? "same handlers" : "different handlers");
+        return FALSE;
+    } else if (new_lookups != expected_new_lookups) {
+        g_printerr("%s: expected %u new lookups\n", description, expected_new_lookups);
+        return FALSE;
+    } else {
+        return TRUE;
+    }
+}
+
+int
+main(int argc, char **argv) {
+    // Point GIO at a private set of applications before it looks anywhere.
+    gchar *tmpdir = g_dir_make_tmp("xfdesktop-app-info-cache-XXXXXX", NULL);
+    g_assert(tmpdir != NULL);
+    gchar *apps_dir = g_build_filename(tmpdir, "applications", NULL);
+    g_mkdir_with_parents(apps_dir, 0700);
+    g_setenv("XDG_DATA_HOME", tmpdir, TRUE);
+    g_setenv("XDG_DATA_DIRS", tmpdir, TRUE);
+    g_setenv("XDG_CONFIG_HOME", tmpdir, TRUE);
+    g_setenv("XDG_CONFIG_DIRS", tmpdir, TRUE);
+
+    for (gsize i = 0; i < G_N_ELEMENTS(test_apps); ++i) {
+        write_desktop_file(apps_dir, test_apps[i].name, test_apps[i].mime_types);
+    }
+
+    gchar *mimeapps = g_build_filename(tmpdir, "mimeapps.list", NULL);
+    g_file_set_contents(mimeapps,
+                        "[Default Applications]\n"
+                        "text/plain=editor.desktop\n"
+                        "text/x-csrc=editor.desktop\n"
+                        "text/x-chdr=other-editor.desktop\n",
+                        -1,
+                        NULL);
+
+    XfdesktopAppInfoCache *cache = xfdesktop_app_info_cache_new();
+    gboolean ok = TRUE;
+
+    const gchar *const all_text[] = { "text/plain" };
+    ok &= check_selection(cache, "single type", all_text, G_N_ELEMENTS(all_text), TRUE, 1);
+
+    const gchar *const mixed_same[] = { "text/plain", "text/x-csrc", "text/x-csrc", "text/plain", "text/x-csrc" };
+    ok &= check_selection(cache, "mixed types, same handlers", mixed_same, G_N_ELEMENTS(mixed_same), TRUE, 1);
+
+    // All cached by now, so this one shouldn't have to ask GIO at all.
+    ok &= check_selection(cache, "mixed types, cached", mixed_same, G_N_ELEMENTS(mixed_same), TRUE, 0);
+
+    const gchar *const mixed_different[] = { "text/plain", "text/x-csrc", "image/png" };
+    ok &= check_selection(cache, "mixed types, different handlers", mixed_different, G_N_ELEMENTS(mixed_different), FALSE, 1);
+
+    // Same handlers, but a different one opens the file by default.
+    const gchar *const mixed_defaults[] = { "text/plain", "text/x-chdr" };
+    ok &= check_selection(cache, "mixed types, different defaults", mixed_defaults, G_N_ELEMENTS(mixed_defaults), FALSE, 1);
+
+    xfdesktop_app_info_cache_free(cache);
+
+    for (gsize i = 0; i < G_N_ELEMENTS(test_apps); ++i) {
+        gchar *filename = desktop_file_path(apps_dir, test_apps[i].name);
+        g_unlink(filename);
+        g_free(filename);
+    }
+    g_unlink(mimeapps);
+    g_rmdir(apps_dir);
+    g_rmdir(tmpdir);
+    g_free(mimeapps);
+    g_free(apps_dir);
+    g_free(tmpdir);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,198 @@
+#include <gio/gio.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+#include "xfdesktop-backdrop-cycler.c"
+
+#define N_IMAGES 2000
+#define N_CHANGED 200
+
+#define LIST_ITERATIONS 5
+#define SORT_ITERATIONS 10
+
+static const guint8 png_signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static void
+report(const gchar *scenario, guint iterations, gint64 elapsed) {
+    g_print("%-28s %4u iterations, total %10.3f ms, average %8.3f ms\n",
+            scenario,
+            iterations,
+            elapsed / 1000.0,
+            elapsed / 1000.0 / iterations);
+}
+
+static GFile *
+image_file(const gchar *dir, guint i) {
+    gchar *name = g_strdup_printf("wallpaper-%05u.png", i);
+    gchar *path = g_build_filename(dir, name, NULL);
+    GFile *file = g_file_new_for_path(path);
+    g_free(path);
+    g_free(name);
+    return file;
+}
+
+static gboolean
+write_image(GFile *file) {
+    return g_file_set_contents(g_file_peek_path(file), (const gchar *)png_signature, sizeof(png_signature), NULL);
+}
+
+// The cycler's constructor wants an xfconf channel, but the list handling
+// only looks at the instance's own fields, so a bare instance will do.
+static XfdesktopBackdropCycler *
+bare_cycler_new(GFile *cur_image_file) {
+    XfdesktopBackdropCycler *cycler = (XfdesktopBackdropCycler *)g_type_create_instance(XFDESKTOP_TYPE_BACKDROP_CYCLER);
+    cycler->enabled = TRUE;
+    cycler->image_style = XFCE_BACKDROP_IMAGE_ZOOMED;
+    cycler->period = XFCE_BACKDROP_PERIOD_MINUTES;
+    cycler->cur_image_file = g_object_ref(cur_image_file);
+    return cycler;
+}
+
+static void
+bare_cycler_free(XfdesktopBackdropCycler *cycler) {
+    g_list_free_full(cycler->image_files, g_object_unref);
+    g_list_free_full(cycler->used_image_files, g_object_unref);
+    g_object_unref(cycler->cur_image_file);
+    g_type_free_instance((GTypeInstance *)cycler);
+}
+
+static gboolean
+is_sorted(GList *files) {
+    for (GList *l = files; l != NULL && l->next != NULL; l = l->next) {
+        if (glist_compare_by_file_collate_key(l->data, l->next->data) > 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+int
+main(int argc, char **argv) {
+    gchar *tmpdir = g_dir_make_tmp("xfdesktop-backdrop-cycler-benchmark-XXXXXX", NULL);
+    g_assert(tmpdir != NULL);
+
+    for (guint i = 0; i < N_IMAGES; ++i) {
+        GFile *file = image_file(tmpdir, i);
+        gboolean written = write_image(file);
+        g_object_unref(file);
+        if (!written) {
+            g_printerr("Failed to write images to %s\n", tmpdir);
+            return EXIT_FAILURE;
+        }
+    }
+
+    g_print("%u images in one directory\n", N_IMAGES);
+
+    GFile *first = image_file(tmpdir, 0);
+    XfdesktopBackdropCycler *cycler = bare_cycler_new(first);
+    g_object_unref(first);
+
+    gboolean ok = TRUE;
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < LIST_ITERATIONS; ++i) {
+        g_list_free_full(cycler->image_files, g_object_unref);
+        cycler->image_files = list_image_files_in_dir(cycler, cycler->cur_image_file);
+    }
+    report("list directory", LIST_ITERATIONS, g_get_monotonic_time() - start);
+
+    if (g_list_length(cycler->image_files) != N_IMAGES || !is_sorted(cycler->image_files)) {
+        g_printerr("Listing found %u images, %s\n",
+                   g_list_length(cycler->image_files),
+                   is_sorted(cycler->image_files) ? "sorted" : "not sorted");
+        ok = FALSE;
+    }
+
+    // Fixed seed, so every run sorts the same input.
+    GRand *rand = g_rand_new_with_seed(0x5eed);
+    gint64 elapsed = 0;
+    for (guint i = 0; i < SORT_ITERATIONS; ++i) {
+        GPtrArray *shuffled = g_ptr_array_new();
+        for (GList *l = cycler->image_files; l != NULL; l = l->next) {
+            g_ptr_array_insert(shuffled, g_rand_int_range(rand, 0, shuffled->len + 1), l->data);
+        }
+        guint j = 0;
+        for (GList *l = cycler->image_files; l != NULL; l = l->next, ++j) {
+            l->data = g_ptr_array_index(shuffled, j);
+        }
+        g_ptr_array_free(shuffled, TRUE);
+
+        start = g_get_monotonic_time();
+        cycler->image_files = sort_image_list(cycler->image_files, N_IMAGES);
+        elapsed += g_get_monotonic_time() - start;
+    }
+    g_rand_free(rand);
+    report("sort list", SORT_ITERATIONS, elapsed);
+    ok &= is_sorted(cycler->image_files);
+
+    // Walk the whole directory once, as if the timer fired N_IMAGES times.
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_IMAGES; ++i) {
+        GFile *next = xfdesktop_backdrop_cycler_choose_next(cycler);
+        g_object_unref(cycler->cur_image_file);
+        cycler->cur_image_file = g_object_ref(next);
+    }
+    report("choose next", N_IMAGES, g_get_monotonic_time() - start);
+
+    // Files showing up in and disappearing from the directory, as the
+    // directory monitor would report them.
+    GFile **changed = g_new0(GFile *, N_CHANGED);
+    for (guint i = 0; i < N_CHANGED; ++i) {
+        changed[i] = image_file(tmpdir, N_IMAGES + i);
+        ok &= write_image(changed[i]);
+    }
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_CHANGED; ++i) {
+        cb_xfdesktop_backdrop_cycler_image_files_changed(NULL, changed[i], NULL, G_FILE_MONITOR_EVENT_CREATED, cycler);
+    }
+    report("file created", N_CHANGED, g_get_monotonic_time() - start);
+
+    if (g_list_length(cycler->image_files) != N_IMAGES + N_CHANGED || !is_sorted(cycler->image_files)) {
+        g_printerr("Adding files left %u images in the list\n", g_list_length(cycler->image_files));
+        ok = FALSE;
+    }
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_CHANGED; ++i) {
+        cb_xfdesktop_backdrop_cycler_image_files_changed(NULL, changed[i], NULL, G_FILE_MONITOR_EVENT_DELETED, cycler);
+    }
+    report("file deleted", N_CHANGED, g_get_monotonic_time() - start);
+
+    if (g_list_length(cycler->image_files) != N_IMAGES) {
+        g_printerr("Removing files left %u images in the list\n", g_list_length(cycler->image_files));
+        ok = FALSE;
+    }
+
+    // Random order draws from the unused list until it runs dry.
+    cycler->random_order = TRUE;
+    g_random_set_seed(0x5eed);
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_IMAGES; ++i) {
+        xfdesktop_backdrop_cycler_choose_random(cycler);
+    }
+    report("choose random", N_IMAGES, g_get_monotonic_time() - start);
+
+    if (cycler->image_files != NULL || g_list_length(cycler->used_image_files) != N_IMAGES) {
+        g_printerr("Random choice didn't use up every image exactly once\n");
+        ok = FALSE;
+    }
+
+    bare_cycler_free(cycler);
+
+    for (guint i = 0; i < N_CHANGED; ++i) {
+        g_object_unref(changed[i]);
+    }
+    g_free(changed);
+
+    for (guint i = 0; i < N_IMAGES + N_CHANGED; ++i) {
+        GFile *file = image_file(tmpdir, i);
+        g_unlink(g_file_peek_path(file));
+        g_object_unref(file);
+    }
+    g_rmdir(tmpdir);
+    g_free(tmpdir);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+#include "xfdesktop-icon-position-configs.c"
+#include "icon-position-fixtures.h"
+
+#define N_CONFIGS 20
+#define N_ICONS 5000
+
+#define LOAD_ITERATIONS 5
+#define SAVE_ITERATIONS 10
+
+static void
+report(const gchar *scenario, guint iterations, gint64 elapsed) {
+    g_print("%-28s %4u iterations, total %10.3f ms, average %8.3f ms\n",
+            scenario,
+            iterations,
+            elapsed / 1000.0,
+            elapsed / 1000.0 / iterations);
+}
+
+static XfdesktopIconPositionConfigs *
+load_configs(const gchar *filename) {
+    GError *error = NULL;
+    XfdesktopIconPositionConfigs *configs = icon_position_fixture_load(filename, &error);
+    if (configs == NULL) {
+        g_printerr("Failed to load configs: %s\n", error->message);
+        g_error_free(error);
+    }
+    return configs;
+}
+
+static void
+cancel_scheduled_save(XfdesktopIconPositionConfigs *configs) {
+    if (configs->scheduled_save_id != 0) {
+        g_source_remove(configs->scheduled_save_id);
+        configs->scheduled_save_id = 0;
+    }
+}
+
+static gboolean
+time_saves(XfdesktopIconPositionConfigs *configs, const gchar *scenario, gboolean touch_all) {
+    gint64 elapsed = 0;
+
+    for (guint i = 0; i < SAVE_ITERATIONS; ++i) {
+        // Moving an icon marks its config dirty; only dirty configs get
+        // serialized again.
+        for (GList *l = configs->configs; l != NULL; l = touch_all ? l->next : NULL) {
+            xfdesktop_icon_position_configs_set_icon_position(configs,
+                                                              l->data,
+                                                              "file-00000.txt",
+                                                              i % 40,
+                                                              0,
+                                                              i);
+        }
+        cancel_scheduled_save(configs);
+
+        gint64 start = g_get_monotonic_time();
+        GError *error = NULL;
+        if (!xfdesktop_icon_position_configs_save(configs, &error)) {
+            g_printerr("%s: failed to save configs: %s\n", scenario, error->message);
+            g_error_free(error);
+            return FALSE;
+        }
+        elapsed += g_get_monotonic_time() - start;
+    }
+
+    report(scenario, SAVE_ITERATIONS, elapsed);
+    return TRUE;
+}
+
+int
+main(int argc, char **argv) {
+    gchar *tmpdir = g_dir_make_tmp("xfdesktop-icon-position-benchmark-XXXXXX", NULL);
+    g_assert(tmpdir != NULL);
+    gchar *filename = g_build_filename(tmpdir, "icons.yaml", NULL);
+    gchar *cache_filename = g_strconcat(filename, POSITION_CACHE_SUFFIX, NULL);
+
+    if (!icon_position_fixture_write(filename, N_CONFIGS, N_ICONS)) {
+        g_printerr("Failed to write %s\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    g_print("%u configs with %u icons each\n", N_CONFIGS, N_ICONS);
+
+    gboolean ok = TRUE;
+
+    gint64 yaml_elapsed = 0;
+    for (guint i = 0; i < LOAD_ITERATIONS && ok; ++i) {
+        // Without the cache, every load has to parse the YAML.
+        g_unlink(cache_filename);
+
+        gint64 start = g_get_monotonic_time();
+        XfdesktopIconPositionConfigs *configs = load_configs(filename);
+        yaml_elapsed += g_get_monotonic_time() - start;
+
+        if (configs != NULL) {
+            ok &= icon_position_fixture_wait_for_cache(filename);
+            xfdesktop_icon_position_configs_free(configs);
+        } else {
+            ok = FALSE;
+        }
+    }
+    report("parse YAML", LOAD_ITERATIONS, yaml_elapsed);
+
+    gint64 cache_elapsed = 0;
+    for (guint i = 0; i < LOAD_ITERATIONS && ok; ++i) {
+        ok &= icon_position_fixture_cache_is_current(filename);
+
+        gint64 start = g_get_monotonic_time();
+        XfdesktopIconPositionConfigs *configs = load_configs(filename);
+        cache_elapsed += g_get_monotonic_time() - start;
+
+        if (configs != NULL) {
+            xfdesktop_icon_position_configs_free(configs);
+        } else {
+            ok = FALSE;
+        }
+    }
+    report("load cache", LOAD_ITERATIONS, cache_elapsed);
+
+    XfdesktopIconPositionConfigs *configs = ok ? load_configs(filename) : NULL;
+    if (configs != NULL) {
+        ok &= time_saves(configs, "save, one config dirty", FALSE);
+        ok &= time_saves(configs, "save, all configs dirty", TRUE);
+        xfdesktop_icon_position_configs_free(configs);
+    } else {
+        ok = FALSE;
+    }
+
+    if (!ok) {
+        g_printerr("Icon position benchmarks failed\n");
+    }
+
+    g_unlink(cache_filename);
+    g_unlink(filename);
+    g_rmdir(tmpdir);
+    g_free(cache_filename);
+    g_free(filename);
+    g_free(tmpdir);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "xfdesktop-icon-position-configs.c"
+#include "icon-position-fixtures.h"
+
+#define N_CONFIGS 20
+#define N_ICONS 5000
+
+static XfdesktopIconPositionConfigs *
+load_configs(const gchar *filename, const gchar *description, gboolean expect_cache) {
+    // The cache is used exactly when the sidecar on disk is current, so
+    // check that rather than asking the loader.
+    gboolean cache_current = icon_position_fixture_cache_is_current(filename);
+    if (cache_current != expect_cache) {
+        g_printerr("%s: expected the cache to be %s\n", description, expect_cache ? "current" : "unusable");
+        return NULL;
+    }
+
+    gint64 start = g_get_monotonic_time();
+    GError *error = NULL;
+    XfdesktopIconPositionConfigs *configs = icon_position_fixture_load(filename, &error);
+    if (configs == NULL) {
+        g_printerr("%s: failed to load configs: %s\n", description, error->message);
+        g_error_free(error);
+        return NULL;
+    }
+    gint64 elapsed = g_get_monotonic_time() - start;
+
+    g_print("%s: loaded %u configs from %s in %.3f ms\n",
+            description,
+            g_list_length(configs->configs),
+            cache_current ? "cache" : "YAML",
+            elapsed / 1000.0);
+
+    // Parsing the YAML must leave a fresh cache behind for next time.
+    if (!cache_current && !icon_position_fixture_wait_for_cache(filename)) {
+        g_printerr("%s: cache was not rewritten\n", description);
+        xfdesktop_icon_position_configs_free(configs);
+        return NULL;
+    }
+
+    return configs;
+}
+
+static XfdesktopIconPositionConfig *
+find_config(XfdesktopIconPositionConfigs *configs, const gchar *monitor_id) {
+    for (GList *l = configs->configs; l != NULL; l = l->next) {
+        XfdesktopIconPositionConfig *config = l->data;
+        if (g_hash_table_contains(config->monitors, monitor_id)) {
+            return config;
+        }
+    }
+    return NULL;
+}
+
+static gboolean
+configs_equal(XfdesktopIconPositionConfigs *a, XfdesktopIconPositionConfigs *b) {
+    if (g_list_length(a->configs) != g_list_length(b->configs)) {
+        g_printerr("different number of configs\n");
+        return FALSE;
+    }
+
+    for (GList *l = a->configs; l != NULL; l = l->next) {
+        XfdesktopIconPositionConfig *config_a = l->data;
+
+        GHashTableIter iter;
+        g_hash_table_iter_init(&iter, config_a->monitors);
+        const gchar *monitor_id;
+        XfdesktopIconPositionMonitor *monitor_a;
+        g_hash_table_iter_next(&iter, (gpointer)&monitor_id, (gpointer)&monitor_a);
+
+        XfdesktopIconPositionConfig *config_b = find_config(b, monitor_id);
+        if (config_b == NULL || config_a->level != config_b->level) {
+            g_printerr("%s: missing config or wrong level\n", monitor_id);
+            return FALSE;
+        }
+
+        XfdesktopIconPositionMonitor *monitor_b = g_hash_table_lookup(config_b->monitors, monitor_id);
+        if (g_hash_table_size(config_a->monitors) != g_hash_table_size(config_b->monitors)
+            || g_strcmp0(monitor_a->display_name, monitor_b->display_name) != 0
+            || !gdk_rectangle_equal(&monitor_a->geometry, &monitor_b->geometry))
+        {
+            g_printerr("%s: monitors differ\n", monitor_id);
+            return FALSE;
+        }
+
+        if (g_hash_table_size(config_a->icon_positions) != g_hash_table_size(config_b->icon_positions)) {
+            g_printerr("%s: different number of icons\n", monitor_id);
+            return FALSE;
+        }
+
+        g_hash_table_iter_init(&iter, config_a->icon_positions);
+        const gchar *icon_id;
+        XfdesktopIconPosition *position_a;
+        while (g_hash_table_iter_next(&iter, (gpointer)&icon_id, (gpointer)&position_a)) {
+            XfdesktopIconPosition *position_b = g_hash_table_lookup(config_b->icon_positions, icon_id);
+            if (position_b == NULL
+                || position_a->row != position_b->row
+                || position_a->col != position_b->col
+                || position_a->last_seen != position_b->last_seen)
+            {
+                g_printerr("%s: position of %s differs\n", monitor_id, icon_id);
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+static void
+corrupt_file(const gchar *filename) {
+    gchar *contents = NULL;
+    gsize len = 0;
+    if (g_file_get_contents(filename, &contents, &len, NULL) && len > 0) {
+        contents[len - 2] ^= 0x55;
+        g_file_set_contents(filename, contents, len, NULL);
+    }
+    g_free(contents);
+}
+
+int
+main(int argc, char **argv) {
+    gchar *tmpdir = g_dir_make_tmp("xfdesktop-icon-position-cache-XXXXXX", NULL);
+    g_assert(tmpdir != NULL);
+    gchar *filename = g_build_filename(tmpdir, "icons.yaml", NULL);
+    gchar *cache_filename = g_strconcat(filename, POSITION_CACHE_SUFFIX, NULL);
+
+    if (!icon_position_fixture_write(filename, N_CONFIGS, N_ICONS)) {
+        g_printerr("Failed to write %s\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    gboolean ok = TRUE;
+
+    // First load has nothing to go on but the YAML; it writes the cache
+    // for next time.
+    XfdesktopIconPositionConfigs *from_yaml = load_configs(filename, "initial load", FALSE);
+    XfdesktopIconPositionConfigs *from_cache = load_configs(filename, "second load", TRUE);
+    ok &= from_yaml != NULL && from_cache != NULL && configs_equal(from_yaml, from_cache);
+    xfdesktop_icon_position_configs_free(from_cache);
+
+    // Saving rewrites both; the cache must follow.
+    if (from_yaml != NULL) {
+        GError *error = NULL;
+        xfdesktop_icon_position_configs_set_icon_position(from_yaml,
+                                                          from_yaml->configs->data,
+                                                          "file-00000.txt",
+                                                          7,
+                                                          7,
+                                                          42);
+        if (!xfdesktop_icon_position_configs_save(from_yaml, &error)) {
+            g_printerr("Failed to save configs: %s\n", error->message);
+            g_error_free(error);
+            ok = FALSE;
+        }
+        g_source_remove(from_yaml->scheduled_save_id);
+        from_yaml->scheduled_save_id = 0;
+
+        from_cache = load_configs(filename, "load after save", TRUE);
+        ok &= from_cache != NULL && configs_equal(from_yaml, from_cache);
+        xfdesktop_icon_position_configs_free(from_cache);
+    }
+
+    // A damaged cache is ignored.
+    corrupt_file(cache_filename);
+    XfdesktopIconPositionConfigs *after_corruption = load_configs(filename, "corrupt cache", FALSE);
+    ok &= after_corruption != NULL && from_yaml != NULL && configs_equal(from_yaml, after_corruption);
+    xfdesktop_icon_position_configs_free(after_corruption);
+
+    // So is one that doesn't match the YAML anymore.
+    FILE *append = fopen(filename, "a");
+    fputs("# edited by hand\n", append);
+    fclose(append);
+    XfdesktopIconPositionConfigs *after_edit = load_configs(filename, "edited YAML", FALSE);
+    ok &= after_edit != NULL && from_yaml != NULL && configs_equal(from_yaml, after_edit);
+    xfdesktop_icon_position_configs_free(after_edit);
+
+    xfdesktop_icon_position_configs_free(from_yaml);
+
+    g_unlink(cache_filename);
+    g_unlink(filename);
+    g_rmdir(tmpdir);
+    g_free(cache_filename);
+    g_free(filename);
+    g_free(tmpdir);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,175 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+#include "xfdesktop-icon-position-configs.c"
+#include "icon-position-fixtures.h"
+
+#define N_CONFIGS 50
+#define N_ICONS 10000
+
+// The straightforward walk over every config that the index replaces.
+static gboolean
+naive_lookup(XfdesktopIconPositionConfigs *configs, const gchar *icon_id, XfwMonitor **monitor, gint *row, gint *col) {
+    gint best_level = XFDESKTOP_ICON_POSITION_LEVEL_INVALID;
+    for (GList *l = configs->configs; l != NULL; l = l->next) {
+        XfdesktopIconPositionConfig *config = l->data;
+        XfwMonitor *config_monitor = g_hash_table_lookup(configs->config_to_monitor, config);
+        if (config_monitor != NULL) {
+            XfdesktopIconPosition *position = g_hash_table_lookup(config->icon_positions, icon_id);
+            if (position != NULL && config->level > best_level) {
+                best_level = config->level;
+                *monitor = config_monitor;
+                *row = position->row;
+                *col = position->col;
+            }
+        }
+    }
+    return best_level != XFDESKTOP_ICON_POSITION_LEVEL_INVALID;
+}
+
+static gboolean
+check_index(XfdesktopIconPositionConfigs *configs, const gchar *icon_id) {
+    guint n_configs = 0;
+    for (GList *l = configs->configs; l != NULL; l = l->next) {
+        XfdesktopIconPositionConfig *config = l->data;
+        if (g_hash_table_contains(config->icon_positions, icon_id)) {
+            n_configs++;
+        }
+    }
+
+    GArray *entries = g_hash_table_lookup(configs->icon_index, icon_id);
+    guint n_entries = entries != NULL ? entries->len : 0;
+    if (n_entries != n_configs) {
+        g_printerr("%s: index has %u entries, but it is in %u configs\n", icon_id, n_entries, n_configs);
+        return FALSE;
+    } else {
+        return TRUE;
+    }
+}
+
+int
+main(int argc, char **argv) {
+    gchar *tmpdir = g_dir_make_tmp("xfdesktop-icon-positions-XXXXXX", NULL);
+    g_assert(tmpdir != NULL);
+    gchar *filename = g_build_filename(tmpdir, "icons.yaml", NULL);
+
+    if (!icon_position_fixture_write(filename, N_CONFIGS, N_ICONS)) {
+        g_printerr("Failed to write %s\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    gint64 start = g_get_monotonic_time();
+    GError *error = NULL;
+    XfdesktopIconPositionConfigs *configs = icon_position_fixture_load(filename, &error);
+    if (configs == NULL) {
+        g_printerr("Failed to parse configs: %s\n", error->message);
+        g_error_free(error);
+        return EXIT_FAILURE;
+    }
+    g_print("loaded %u configs x %u icons in %.3f ms\n",
+            g_list_length(configs->configs),
+            N_ICONS,
+            (g_get_monotonic_time() - start) / 1000.0);
+
+    // One assigned config per level, as if there were three monitors
+    // connected.  The monitors are never dereferenced, so any distinct
+    // pointer will do.
+    XfdesktopIconPositionConfig *assigned[3] = { NULL, NULL, NULL };
+    static gint fake_monitors[3];
+    for (GList *l = configs->configs; l != NULL; l = l->next) {
+        XfdesktopIconPositionConfig *config = l->data;
+        if (assigned[config->level] == NULL) {
+            assigned[config->level] = config;
+            g_hash_table_insert(configs->config_to_monitor, config, &fake_monitors[config->level]);
+        }
+    }
+
+    gchar **names = g_new0(gchar *, N_ICONS + 1);
+    for (guint i = 0; i < N_ICONS; ++i) {
+        names[i] = icon_position_fixture_icon_name(i);
+    }
+
+    gboolean ok = TRUE;
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_ICONS; ++i) {
+        XfwMonitor *naive_monitor = NULL;
+        gint naive_row = -1, naive_col = -1;
+        naive_lookup(configs, names[i], &naive_monitor, &naive_row, &naive_col);
+    }
+    gint64 naive_time = g_get_monotonic_time() - start;
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_ICONS; ++i) {
+        xfdesktop_icon_position_configs_lookup(configs, names[i], NULL, NULL, NULL);
+    }
+    gint64 indexed_time = g_get_monotonic_time() - start;
+
+    g_print("lookup of %u icons: %.3f ms walking configs, %.3f ms indexed\n",
+            N_ICONS,
+            naive_time / 1000.0,
+            indexed_time / 1000.0);
+
+    for (guint i = 0; i < N_ICONS && ok; ++i) {
+        XfwMonitor *naive_monitor = NULL, *monitor = NULL;
+        gint naive_row = -1, naive_col = -1, row = -1, col = -1;
+        gboolean naive_found = naive_lookup(configs, names[i], &naive_monitor, &naive_row, &naive_col);
+        gboolean found = xfdesktop_icon_position_configs_lookup(configs, names[i], &monitor, &row, &col);
+        if (found != naive_found || monitor != naive_monitor || row != naive_row || col != naive_col) {
+            g_printerr("%s: lookup mismatch\n", names[i]);
+            ok = FALSE;
+        }
+    }
+
+    // Moving every icon onto the secondary monitor drops it from all other
+    // configs of the same or higher level.
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_ICONS; ++i) {
+        xfdesktop_icon_position_configs_set_icon_position(configs, assigned[1], names[i], i % 40, 0, 0);
+    }
+    g_print("set position of %u icons in %.3f ms\n", N_ICONS, (g_get_monotonic_time() - start) / 1000.0);
+
+    for (guint i = 0; i < N_ICONS && ok; ++i) {
+        XfwMonitor *monitor = NULL;
+        gint row = -1;
+        if (!xfdesktop_icon_position_configs_lookup(configs, names[i], &monitor, &row, NULL)
+            || monitor != (XfwMonitor *)&fake_monitors[1]
+            || row != (gint)(i % 40))
+        {
+            g_printerr("%s: not found on the secondary monitor after moving it there\n", names[i]);
+            ok = FALSE;
+        }
+        ok &= check_index(configs, names[i]);
+    }
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < N_ICONS; i += 2) {
+        xfdesktop_icon_position_configs_remove_icon_from_all(configs, names[i]);
+    }
+    g_print("removed %u icons from all configs in %.3f ms\n", N_ICONS / 2, (g_get_monotonic_time() - start) / 1000.0);
+
+    for (guint i = 0; i < N_ICONS && ok; ++i) {
+        gboolean found = xfdesktop_icon_position_configs_lookup(configs, names[i], NULL, NULL, NULL);
+        if (found != (i % 2 == 1)) {
+            g_printerr("%s: %s after removing every other icon\n", names[i], found ? "still found" : "missing");
+            ok = FALSE;
+        }
+        ok &= check_index(configs, names[i]);
+    }
+
+    // Don't spend time writing half a million positions back out.
+    if (configs->scheduled_save_id != 0) {
+        g_source_remove(configs->scheduled_save_id);
+        configs->scheduled_save_id = 0;
+    }
+    xfdesktop_icon_position_configs_free(configs);
+
+    g_strfreev(names);
+    g_unlink(filename);
+    g_rmdir(tmpdir);
+    g_free(filename);
+    g_free(tmpdir);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,460 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <libxfce4windowing/libxfce4windowing.h>
+#include <stdlib.h>
+#include <xfconf/xfconf.h>
+
+#include "xfdesktop-icon-view.c"
+
+#define N_ITEMS 3000
+#define LARGE_WIDTH 7680
+#define LARGE_HEIGHT 4320
+#define SMALL_WIDTH 5120
+#define SMALL_HEIGHT 2880
+
+#define POPULATE_ITERATIONS 10
+#define DRAW_ITERATIONS 50
+#define RESIZE_ITERATIONS 20
+#define SORT_ITERATIONS 10
+#define BAND_STEPS 400
+#define TYPE_AHEAD_ITERATIONS 200
+#define N_THUMBNAILS 500
+// Two image files, portrait and landscape, shared by all the thumbnails.
+#define N_THUMBNAIL_FILES 2
+
+// Exit status that tells meson a benchmark was skipped.
+#define EXIT_SKIPPED 77
+
+enum {
+    COL_ICON = 0,
+    COL_LABEL,
+    N_COLS,
+};
+
+static void
+report(const gchar *scenario, guint iterations, gint64 elapsed) {
+    g_print("%-28s %4u iterations, total %10.3f ms, average %8.3f ms\n",
+            scenario,
+            iterations,
+            elapsed / 1000.0,
+            elapsed / 1000.0 / iterations);
+}
+
+static GtkTreeModel *
+build_model(void) {
+    GtkListStore *store = gtk_list_store_new(N_COLS, G_TYPE_ICON, G_TYPE_STRING);
+    const gchar *icon_names[] = {
+        "text-x-generic",
+        "image-x-generic",
+        "folder",
+        "application-x-executable",
+    };
+
+    // Fixed seed, so the sort scenario sees the same shuffled input every run.
+    GRand *rand = g_rand_new_with_seed(0x5eed);
+    for (guint i = 0; i < N_ITEMS; ++i) {
+        GIcon *icon = g_themed_icon_new(icon_names[i % G_N_ELEMENTS(icon_names)]);
+        gchar *label = g_strdup_printf("Document %05u.txt", g_rand_int_range(rand, 0, N_ITEMS * 10));
+        gtk_list_store_insert_with_values(store, NULL, -1,
+                                          COL_ICON, icon,
+                                          COL_LABEL, label,
+                                          -1);
+        g_free(label);
+        g_object_unref(icon);
+    }
+    g_rand_free(rand);
+
+    return GTK_TREE_MODEL(store);
+}
+
+// Half portrait, half landscape, like a folder full of photos.
+static gchar *
+thumbnail_path(const gchar *dir, guint i) {
+    return g_strdup_printf("%s/thumbnail-%u.png", dir, i);
+}
+
+static GtkTreeModel *
+build_thumbnail_model(const gchar *dir) {
+    GtkListStore *store = gtk_list_store_new(N_COLS, G_TYPE_ICON, G_TYPE_STRING);
+    GFile *files[N_THUMBNAIL_FILES] = { NULL, NULL };
+    const gint sizes[N_THUMBNAIL_FILES][2] = { { 768, 1024 }, { 1024, 768 } };
+
+    for (guint i = 0; i < N_THUMBNAIL_FILES; ++i) {
+        GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, sizes[i][0], sizes[i][1]);
+        gchar *path = thumbnail_path(dir, i);
+        gdk_pixbuf_fill(pix, 0x336699ff);
+        if (gdk_pixbuf_save(pix, path, "png", NULL, NULL)) {
+            files[i] = g_file_new_for_path(path);
+        }
+        g_free(path);
+        g_object_unref(pix);
+    }
+
+    if (files[0] == NULL || files[1] == NULL) {
+        g_clear_object(&files[0]);
+        g_clear_object(&files[1]);
+        g_object_unref(store);
+        return NULL;
+    }
+
+    for (guint i = 0; i < N_THUMBNAILS; ++i) {
+        GIcon *icon = g_file_icon_new(files[i % N_THUMBNAIL_FILES]);
+        gchar *label = g_strdup_printf("Photo %05u.jpg", i);
+        gtk_list_store_insert_with_values(store, NULL, -1,
+                                          COL_ICON, icon,
+                                          COL_LABEL, label,
+                                          -1);
+        g_free(label);
+        g_object_unref(icon);
+    }
+
+    g_object_unref(files[0]);
+    g_object_unref(files[1]);
+
+    return GTK_TREE_MODEL(store);
+}
+
+static guint
+count_placed(XfdesktopIconView *icon_view) {
+    guint n_placed = 0;
+    for (GList *l = icon_view->items; l != NULL; l = l->next) {
+        ViewItem *item = l->data;
+        if (item->placed) {
+            n_placed++;
+        }
+    }
+    return n_placed;
+}
+
+static void
+allocate(GtkWidget *widget, gint width, gint height) {
+    GtkAllocation allocation = {
+        .x = 0,
+        .y = 0,
+        .width = width,
+        .height = height,
+    };
+    gtk_widget_get_preferred_size(widget, NULL, NULL);
+    gtk_widget_size_allocate(widget, &allocation);
+}
+
+static gint64
+time_draw(GtkWidget *widget, cairo_surface_t *surface, const GdkRectangle *clip, guint iterations) {
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < iterations; ++i) {
+        cairo_t *cr = cairo_create(surface);
+        gdk_cairo_rectangle(cr, clip);
+        cairo_clip(cr);
+        xfdesktop_icon_view_draw(widget, cr);
+        cairo_destroy(cr);
+    }
+    return g_get_monotonic_time() - start;
+}
+
+static void
+band_motion(GtkWidget *widget, gint x, gint y) {
+    GdkEvent *event = gdk_event_new(GDK_MOTION_NOTIFY);
+    event->motion.window = g_object_ref(gtk_widget_get_window(widget));
+    event->motion.x = x;
+    event->motion.y = y;
+    xfdesktop_icon_view_motion_notify(widget, &event->motion);
+    gdk_event_free(event);
+}
+
+static guint
+count_in_band(XfdesktopIconView *icon_view) {
+    guint n_in_band = 0;
+    for (GList *l = icon_view->items; l != NULL; l = l->next) {
+        ViewItem *item = l->data;
+        if (item->placed
+            && cairo_region_contains_rectangle(item->icon_slot_region, &icon_view->band_rect) != CAIRO_REGION_OVERLAP_OUT)
+        {
+            n_in_band++;
+        }
+    }
+    return n_in_band;
+}
+
+static void
+band_press(XfdesktopIconView *icon_view, gint x0, gint y0) {
+    xfdesktop_icon_view_unselect_all(icon_view);
+    icon_view->item_under_pointer = NULL;
+    icon_view->maybe_begin_drag = TRUE;
+    icon_view->definitely_rubber_banding = FALSE;
+    icon_view->press_start_x = x0;
+    icon_view->press_start_y = y0;
+}
+
+// Ends the band, returning FALSE if the selection doesn't match what's
+// under it.
+static gboolean
+band_release(XfdesktopIconView *icon_view, const gchar *scenario) {
+    guint n_selected = g_list_length(icon_view->selected_items);
+    guint n_in_band = count_in_band(icon_view);
+
+    icon_view->maybe_begin_drag = FALSE;
+    icon_view->definitely_rubber_banding = FALSE;
+
+    if (n_selected != n_in_band) {
+        g_printerr("%s: %u items selected, but %u are in the band\n", scenario, n_selected, n_in_band);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Presses at (x0, y0), then drags the band through 'steps' motion events,
+// calling 'position' for each step's pointer position.  Returns FALSE if
+// the selection doesn't match what's under the final band.
+static gboolean
+time_band(GtkWidget *widget,
+          const gchar *scenario,
+          gint x0,
+          gint y0,
+          void (*position)(guint step, gint *x, gint *y))
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
+
+    band_press(icon_view, x0, y0);
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < BAND_STEPS; ++i) {
+        gint x, y;
+        position(i, &x, &y);
+        band_motion(widget, x, y);
+    }
+    report(scenario, BAND_STEPS, g_get_monotonic_time() - start);
+
+    return band_release(icon_view, scenario);
+}
+
+// Drags a band out to width x height, then times small pointer movements
+// around that corner.  Each motion only looks at the slots along the edges
+// that moved, so quadrupling the band's area should at most double the time
+// per motion, not quadruple it.
+static gboolean
+time_band_motion_at_size(GtkWidget *widget, const gchar *scenario, gint width, gint height) {
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
+
+    band_press(icon_view, 10, 10);
+    band_motion(widget, 10 + width, 10 + height);
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < BAND_STEPS; ++i) {
+        gint offset = ((gint)(i % 8) - 4) * 6;
+        band_motion(widget, 10 + width + offset, 10 + height + offset);
+    }
+    report(scenario, BAND_STEPS, g_get_monotonic_time() - start);
+
+    return band_release(icon_view, scenario);
+}
+
+static void
+band_grow(guint step, gint *x, gint *y) {
+    *x = 10 + (LARGE_WIDTH - 20) * (step + 1) / BAND_STEPS;
+    *y = 10 + (LARGE_HEIGHT - 20) * (step + 1) / BAND_STEPS;
+}
+
+static void
+band_shrink(guint step, gint *x, gint *y) {
+    *x = LARGE_WIDTH - 10 - (LARGE_WIDTH / 2) * (step + 1) / BAND_STEPS;
+    *y = LARGE_HEIGHT - 10 - (LARGE_HEIGHT / 2) * (step + 1) / BAND_STEPS;
+}
+
+static void
+band_jitter(guint step, gint *x, gint *y) {
+    // Wobbling back and forth across the press point, flipping the band
+    // from one side to the other.
+    gint offset = (step % 2 == 0 ? 1 : -1) * (50 + (step % 7) * 40);
+    *x = LARGE_WIDTH / 2 + offset;
+    *y = LARGE_HEIGHT / 2 + offset / 2;
+}
+
+int
+main(int argc, char **argv) {
+    if (!gtk_init_check(&argc, &argv)) {
+        g_print("No display available; skipping icon view benchmarks\n");
+        return EXIT_SKIPPED;
+    }
+
+    GError *error = NULL;
+    if (!xfconf_init(&error)) {
+        g_print("Unable to connect to xfconf (%s); skipping icon view benchmarks\n", error->message);
+        g_error_free(error);
+        return EXIT_SKIPPED;
+    }
+
+    // A channel of our own, so the user's desktop settings don't leak into
+    // the numbers.
+    XfconfChannel *channel = xfconf_channel_new("xfdesktop-benchmark");
+    XfwScreen *screen = xfw_screen_get_default();
+    GtkTreeModel *model = build_model();
+
+    GtkWidget *icon_view = xfdesktop_icon_view_new(channel, screen);
+    xfdesktop_icon_view_set_pixbuf_column(XFDESKTOP_ICON_VIEW(icon_view), COL_ICON);
+    xfdesktop_icon_view_set_text_column(XFDESKTOP_ICON_VIEW(icon_view), COL_LABEL);
+    xfdesktop_icon_view_set_search_column(XFDESKTOP_ICON_VIEW(icon_view), COL_LABEL);
+    gtk_widget_set_size_request(icon_view, LARGE_WIDTH, LARGE_HEIGHT);
+
+    GtkWidget *window = gtk_offscreen_window_new();
+    gtk_container_add(GTK_CONTAINER(window), icon_view);
+    gtk_widget_show_all(window);
+    allocate(icon_view, LARGE_WIDTH, LARGE_HEIGHT);
+
+    g_print("%u items on a %dx%d desktop (%dx%d grid)\n",
+            N_ITEMS,
+            LARGE_WIDTH,
+            LARGE_HEIGHT,
+            XFDESKTOP_ICON_VIEW(icon_view)->nrows,
+            XFDESKTOP_ICON_VIEW(icon_view)->ncols);
+
+    gboolean ok = TRUE;
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < POPULATE_ITERATIONS; ++i) {
+        xfdesktop_icon_view_set_model(XFDESKTOP_ICON_VIEW(icon_view), NULL);
+        xfdesktop_icon_view_set_model(XFDESKTOP_ICON_VIEW(icon_view), model);
+    }
+    report("populate", POPULATE_ITERATIONS, g_get_monotonic_time() - start);
+
+    guint n_placed = count_placed(XFDESKTOP_ICON_VIEW(icon_view));
+    if (n_placed == 0) {
+        g_printerr("No items were placed on the grid\n");
+        ok = FALSE;
+    }
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, LARGE_WIDTH, LARGE_HEIGHT);
+
+    // The first draw renders and caches every icon surface; it's the
+    // repaints after that we care about.
+    GdkRectangle full_clip = { 0, 0, LARGE_WIDTH, LARGE_HEIGHT };
+    GdkRectangle partial_clip = { LARGE_WIDTH / 4, LARGE_HEIGHT / 4, 400, 300 };
+    report("first draw", 1, time_draw(icon_view, surface, &full_clip, 1));
+    report("draw, full clip", DRAW_ITERATIONS, time_draw(icon_view, surface, &full_clip, DRAW_ITERATIONS));
+    report("draw, partial clip", DRAW_ITERATIONS, time_draw(icon_view, surface, &partial_clip, DRAW_ITERATIONS));
+
+    // Selected icons are drawn tinted.
+    xfdesktop_icon_view_select_all(XFDESKTOP_ICON_VIEW(icon_view));
+    report("first draw, all selected", 1, time_draw(icon_view, surface, &full_clip, 1));
+    report("draw, all selected", DRAW_ITERATIONS, time_draw(icon_view, surface, &full_clip, DRAW_ITERATIONS));
+    xfdesktop_icon_view_unselect_all(XFDESKTOP_ICON_VIEW(icon_view));
+
+    cairo_surface_destroy(surface);
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < RESIZE_ITERATIONS; ++i) {
+        if (i % 2 == 0) {
+            allocate(icon_view, SMALL_WIDTH, SMALL_HEIGHT);
+        } else {
+            allocate(icon_view, LARGE_WIDTH, LARGE_HEIGHT);
+        }
+    }
+    report("grid resize", RESIZE_ITERATIONS, g_get_monotonic_time() - start);
+
+    ok &= time_band(icon_view, "rubber band, grow", 10, 10, band_grow);
+    ok &= time_band(icon_view, "rubber band, shrink", LARGE_WIDTH / 2, LARGE_HEIGHT / 2, band_shrink);
+    ok &= time_band(icon_view, "rubber band, jitter", LARGE_WIDTH / 2, LARGE_HEIGHT / 2, band_jitter);
+    for (guint divisor = 8; divisor >= 1; divisor /= 2) {
+        gchar *scenario = g_strdup_printf("rubber band motion, 1/%u", divisor);
+        ok &= time_band_motion_at_size(icon_view, scenario, (LARGE_WIDTH - 40) / divisor, (LARGE_HEIGHT - 40) / divisor);
+        g_free(scenario);
+    }
+    xfdesktop_icon_view_unselect_all(XFDESKTOP_ICON_VIEW(icon_view));
+
+    if (count_placed(XFDESKTOP_ICON_VIEW(icon_view)) != n_placed) {
+        g_printerr("Resizing back to the original size placed %u items, not %u\n",
+                   count_placed(XFDESKTOP_ICON_VIEW(icon_view)),
+                   n_placed);
+        ok = FALSE;
+    }
+
+    // Typing "document 1" a character at a time; the first keystroke
+    // matches every item.
+    const gchar *typed = "document 1";
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < TYPE_AHEAD_ITERATIONS && ok; ++i) {
+        for (const gchar *p = typed; *p != '\0'; ++p) {
+            if (!xfdesktop_icon_view_keyboard_navigate(XFDESKTOP_ICON_VIEW(icon_view), (gunichar)*p)) {
+                g_printerr("Type-ahead found no match for the prefix ending at '%c'\n", *p);
+                ok = FALSE;
+                break;
+            }
+        }
+        xfdesktop_icon_view_cancel_keyboard_navigation(XFDESKTOP_ICON_VIEW(icon_view));
+    }
+    report("type-ahead", TYPE_AHEAD_ITERATIONS, g_get_monotonic_time() - start);
+    xfdesktop_icon_view_unselect_all(XFDESKTOP_ICON_VIEW(icon_view));
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < SORT_ITERATIONS; ++i) {
+        xfdesktop_icon_view_sort_icons(XFDESKTOP_ICON_VIEW(icon_view),
+                                       i % 2 == 0 ? GTK_SORT_ASCENDING : GTK_SORT_DESCENDING);
+    }
+    report("sort", SORT_ITERATIONS, g_get_monotonic_time() - start);
+
+    // As if every label had changed since the last sort.
+    gint64 elapsed = 0;
+    for (guint i = 0; i < SORT_ITERATIONS; ++i) {
+        xfdesktop_icon_view_invalidate_sort_keys(XFDESKTOP_ICON_VIEW(icon_view));
+        start = g_get_monotonic_time();
+        xfdesktop_icon_view_sort_icons(XFDESKTOP_ICON_VIEW(icon_view),
+                                       i % 2 == 0 ? GTK_SORT_ASCENDING : GTK_SORT_DESCENDING);
+        elapsed += g_get_monotonic_time() - start;
+    }
+    report("sort, new labels", SORT_ITERATIONS, elapsed);
+
+    if (count_placed(XFDESKTOP_ICON_VIEW(icon_view)) != n_placed) {
+        g_printerr("Sorting placed %u items, not %u\n", count_placed(XFDESKTOP_ICON_VIEW(icon_view)), n_placed);
+        ok = FALSE;
+    }
+
+    // Every thumbnail should be decoded exactly once, on the first draw.
+    gchar *tmpdir = g_dir_make_tmp("xfdesktop-icon-view-benchmark-XXXXXX", NULL);
+    GtkTreeModel *thumbnail_model = tmpdir != NULL ? build_thumbnail_model(tmpdir) : NULL;
+    if (thumbnail_model != NULL) {
+        XfdesktopIconView *view = XFDESKTOP_ICON_VIEW(icon_view);
+        xfdesktop_icon_view_set_model(view, thumbnail_model);
+
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, LARGE_WIDTH, LARGE_HEIGHT);
+        guint n_thumbnails_placed = count_placed(view);
+        guint n_decodes = view->n_icon_decodes;
+        report("first draw, thumbnails", 1, time_draw(icon_view, surface, &full_clip, 1));
+        g_print("%-28s %4u decodes for %u thumbnails\n", "", view->n_icon_decodes - n_decodes, n_thumbnails_placed);
+        if (view->n_icon_decodes - n_decodes != n_thumbnails_placed) {
+            g_printerr("Drawing %u thumbnails took %u decodes\n", n_thumbnails_placed, view->n_icon_decodes - n_decodes);
+            ok = FALSE;
+        }
+
+        n_decodes = view->n_icon_decodes;
+        report("draw, thumbnails", DRAW_ITERATIONS, time_draw(icon_view, surface, &full_clip, DRAW_ITERATIONS));
+        if (view->n_icon_decodes != n_decodes) {
+            g_printerr("Redrawing thumbnails decoded %u images\n", view->n_icon_decodes - n_decodes);
+            ok = FALSE;
+        }
+
+        cairo_surface_destroy(surface);
+        xfdesktop_icon_view_set_model(view, NULL);
+        g_object_unref(thumbnail_model);
+    } else {
+        g_printerr("Failed to write thumbnails\n");
+        ok = FALSE;
+    }
+
+    if (tmpdir != NULL) {
+        for (guint i = 0; i < N_THUMBNAIL_FILES; ++i) {
+            gchar *path = thumbnail_path(tmpdir, i);
+            g_unlink(path);
+            g_free(path);
+        }
+        g_rmdir(tmpdir);
+        g_free(tmpdir);
+    }
+
+    gtk_widget_destroy(window);
+    g_object_unref(model);
+    g_object_unref(screen);
+    g_object_unref(channel);
+    xfconf_shutdown();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,175 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "xfdesktop-background-settings.c"
+
+#define N_PREVIEWS 500
+
+typedef struct {
+    GMutex lock;
+    GPtrArray *previews;  // PreviewData, in the order the pool got to them
+} Order;
+
+static void
+record_preview(gpointer data, gpointer user_data) {
+    Order *order = user_data;
+
+    g_mutex_lock(&order->lock);
+    g_ptr_array_add(order->previews, data);
+    g_mutex_unlock(&order->lock);
+}
+
+// Queues one preview per row, in row order, while the pool is stopped, then
+// lets a single worker run through them.  Returns the rows the previews were
+// for, as they are once everything's done.
+static GArray *
+run_pool(gint visible_start, gint visible_end, gint scrolled_start, gint scrolled_end, gint inserted_above) {
+    XfdesktopBackgroundSettings *background_settings = g_new0(XfdesktopBackgroundSettings, 1);
+    background_settings->preview_visible_start = -1;
+    background_settings->preview_visible_end = -1;
+    background_settings->preview_model = gtk_list_store_new(1, G_TYPE_STRING);
+    background_settings->previews_pending = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    Order order;
+    g_mutex_init(&order.lock);
+    order.previews = g_ptr_array_sized_new(N_PREVIEWS);
+
+    background_settings->preview_pool = g_thread_pool_new(record_preview, &order, 1, FALSE, NULL);
+    g_thread_pool_set_max_threads(background_settings->preview_pool, 0, NULL);
+
+    xfdesktop_settings_set_preview_visible_range(background_settings, visible_start, visible_end);
+    for (gint i = 0; i < N_PREVIEWS; ++i) {
+        PreviewData *pdata = g_new0(PreviewData, 1);
+        gtk_list_store_insert(background_settings->preview_model, &pdata->iter, i);
+        pdata->seq = background_settings->preview_seq++;
+        xfdesktop_settings_push_preview(background_settings, pdata);
+    }
+
+    // New files showed up that sort before everything that's queued, so the
+    // icon view's visible range now covers different rows.
+    for (gint i = 0; i < inserted_above; ++i) {
+        gtk_list_store_insert(background_settings->preview_model, NULL, 0);
+        background_settings->preview_order_stale = TRUE;
+    }
+
+    // The user scrolled before any of the previews got made.
+    xfdesktop_settings_set_preview_visible_range(background_settings, scrolled_start, scrolled_end);
+
+    g_thread_pool_set_max_threads(background_settings->preview_pool, 1, NULL);
+    g_thread_pool_free(background_settings->preview_pool, FALSE, TRUE);
+
+    g_hash_table_destroy(background_settings->previews_pending);
+
+    GArray *positions = g_array_sized_new(FALSE, FALSE, sizeof(gint), order.previews->len);
+    for (guint i = 0; i < order.previews->len; ++i) {
+        PreviewData *pdata = g_ptr_array_index(order.previews, i);
+        gint position = preview_data_position(background_settings, pdata);
+        g_array_append_val(positions, position);
+        g_free(pdata);
+    }
+
+    g_ptr_array_free(order.previews, TRUE);
+    g_mutex_clear(&order.lock);
+    g_object_unref(background_settings->preview_model);
+    g_free(background_settings);
+
+    return positions;
+}
+
+static gboolean
+check_order(const gchar *scenario, GArray *positions, gint first, gint start, gint end) {
+    gint last = first + N_PREVIEWS - 1;
+    gint n_visible = end - start + 1;
+    gint nearby = MAX(n_visible * PREVIEW_NEARBY_PAGES, PREVIEW_NEARBY_MIN);
+    gint last_distance = 0;
+    gint last_far = -1;
+    guint i = 0;
+
+    if (positions->len != N_PREVIEWS) {
+        g_printerr("%s: %u of %u previews were made\n", scenario, positions->len, N_PREVIEWS);
+        return FALSE;
+    }
+
+    // Visible rows first, top to bottom.
+    for (; i < (guint)n_visible; ++i) {
+        gint position = g_array_index(positions, gint, i);
+        if (position != start + (gint)i) {
+            g_printerr("%s: preview %u was for row %d, expected visible row %d\n", scenario, i, position, start + (gint)i);
+            return FALSE;
+        }
+    }
+
+    // Then the rows around them, closest first, until those run out.
+    for (; i < positions->len; ++i) {
+        gint position = g_array_index(positions, gint, i);
+        gint distance = position < start ? start - position : position - end;
+        if (distance > nearby) {
+            break;
+        } else if (distance < last_distance) {
+            g_printerr("%s: row %d (distance %d) came after a row at distance %d\n",
+                       scenario, position, distance, last_distance);
+            return FALSE;
+        }
+        last_distance = distance;
+    }
+
+    gint expected_nearby = MIN(start - first, nearby) + MIN(last - end, nearby);
+    if ((gint)i - n_visible != expected_nearby) {
+        g_printerr("%s: %d nearby previews, expected %d\n", scenario, (gint)i - n_visible, expected_nearby);
+        return FALSE;
+    }
+
+    // Everything else in the order it was queued.
+    for (; i < positions->len; ++i) {
+        gint position = g_array_index(positions, gint, i);
+        if (position >= start - nearby && position <= end + nearby) {
+            g_printerr("%s: row %d near the visible range came after far away rows\n", scenario, position);
+            return FALSE;
+        } else if (position < last_far) {
+            g_printerr("%s: far away row %d came after row %d\n", scenario, position, last_far);
+            return FALSE;
+        }
+        last_far = position;
+    }
+
+    return TRUE;
+}
+
+int
+main(int argc, char **argv) {
+    gboolean ok = TRUE;
+
+    GArray *positions = run_pool(200, 219, 200, 219, 0);
+    ok &= check_order("middle of the list", positions, 0, 200, 219);
+    g_array_free(positions, TRUE);
+
+    positions = run_pool(0, 9, 0, 9, 0);
+    ok &= check_order("top of the list", positions, 0, 0, 9);
+    g_array_free(positions, TRUE);
+
+    positions = run_pool(0, 19, 470, 489, 0);
+    ok &= check_order("scrolled to the bottom", positions, 0, 470, 489);
+    g_array_free(positions, TRUE);
+
+    positions = run_pool(200, 219, 200, 219, 100);
+    ok &= check_order("rows inserted above", positions, 100, 200, 219);
+    g_array_free(positions, TRUE);
+
+    // Before the icon view knows what's visible, previews are made in the
+    // order they were queued.
+    positions = run_pool(-1, -1, -1, -1, 0);
+    if (positions->len != N_PREVIEWS) {
+        g_printerr("nothing visible: %u of %u previews were made\n", positions->len, N_PREVIEWS);
+        ok = FALSE;
+    }
+    for (guint i = 0; i < positions->len; ++i) {
+        if (g_array_index(positions, gint, i) != (gint)i) {
+            g_printerr("nothing visible: preview %u was for row %d\n", i, g_array_index(positions, gint, i));
+            ok = FALSE;
+            break;
+        }
+    }
+    g_array_free(positions, TRUE);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}